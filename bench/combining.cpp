@@ -0,0 +1,100 @@
+/// throughput of small 'merge' calls from many threads on one map:
+/// a plain std::mutex wrapper vs the flat combining front end
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "intervals/combining.h"
+#include "intervals/map.h"
+
+namespace {
+
+    using u64       = std::uint64_t;
+    using ival_type = intervals::interval<u64>;
+    using map_type  = intervals::map<u64, u64>;
+    using clock     = std::chrono::steady_clock;
+
+    const u64 range = 1 << 20;
+
+    /// the same calls as 'combining<>::handle' has, under one mutex
+    class locked_map {
+
+    public:
+
+        class handle {
+        public:
+            explicit handle( locked_map *owner )
+                :owner_(owner)
+            { }
+
+            void merge( map_type::value_type val )
+            {
+                std::lock_guard<std::mutex> lck(owner_->lock_);
+                owner_->map_.merge( std::move(val) );
+            }
+
+        private:
+            locked_map *owner_;
+        };
+
+        handle attach( )
+        {
+            return handle( this );
+        }
+
+    private:
+        map_type   map_;
+        std::mutex lock_;
+    };
+
+    template <typename FrontT>
+    double run( std::size_t threads, std::size_t calls )
+    {
+        FrontT front;
+        std::vector<std::thread> workers;
+
+        auto start = clock::now( );
+        for( std::size_t t = 0; t < threads; t++ ) {
+            workers.emplace_back( [&front, t, calls]( ) {
+                std::mt19937_64 gen( t + 1 );
+                std::uniform_int_distribution<u64> ud( 0, range );
+                auto h = front.attach( );
+                for( std::size_t i = 0; i < calls; i++ ) {
+                    u64 left = ud( gen );
+                    h.merge( std::make_pair(
+                             ival_type::left_closed( left, left + 4 ), i ) );
+                }
+            } );
+        }
+        for( auto &w: workers ) {
+            w.join( );
+        }
+        std::chrono::duration<double> spent = clock::now( ) - start;
+
+        return double(threads * calls) / spent.count( );
+    }
+}
+
+int main( )
+{
+    const std::size_t calls = 1 << 15;
+
+    std::cout << "merge calls per second; "
+              << calls << " calls per thread\n\n";
+
+    for( std::size_t threads: { 1, 2, 4, 8, 16, 32 } ) {
+        double locked    = run<locked_map>( threads, calls );
+        double combined  = run<intervals::combining<map_type> >( threads,
+                                                                 calls );
+        std::cout << threads << " threads\n"
+                  << "    std::mutex: " << locked << "\n"
+                  << "    combining:  " << combined << "\n";
+    }
+
+    return 0;
+}
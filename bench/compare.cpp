@@ -0,0 +1,86 @@
+/// time of 'lower_bound' over a sorted array with the attribute
+/// by attribute comparison vs the encoded endpoint keys.
+/// The elements have random open/closed ends, so the switches
+/// of the attribute version can't be predicted
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "intervals/interval.h"
+
+namespace {
+
+    using u64       = std::uint64_t;
+    using ival_type = intervals::interval<u64>;
+    using cmp       = ival_type::cmp_not_overlap;
+    using clock     = std::chrono::steady_clock;
+
+    ival_type make( std::mt19937_64 &gen, u64 left, u64 right )
+    {
+        switch( gen( ) % 4 ) {
+        case 0:  return ival_type::left_closed( left, right );
+        case 1:  return ival_type::closed( left, right );
+        case 2:  return ival_type::open( left, right );
+        default: return ival_type::left_open( left, right );
+        }
+    }
+
+    template <typename LessT>
+    void run( const char *name, const std::vector<ival_type> &arr,
+              const std::vector<ival_type> &keys, LessT less )
+    {
+        std::size_t sink = 0;
+        auto start = clock::now( );
+        for( int round = 0; round < 10; round++ ) {
+            for( auto &k: keys ) {
+                auto itr = std::lower_bound( arr.begin( ), arr.end( ),
+                                             k, less );
+                sink += ( itr - arr.begin( ) );
+            }
+        }
+        std::chrono::duration<double, std::nano> spent = clock::now( )
+                                                       - start;
+
+        std::cout << name << ": "
+                  << spent.count( ) / ( keys.size( ) * 10 )
+                  << " ns per lower_bound (" << sink << ")\n";
+    }
+
+    void run_all( std::size_t count )
+    {
+        std::mt19937_64 gen( 1 );
+        std::vector<ival_type> arr;
+        for( u64 i = 0; i < count; i++ ) {
+            arr.push_back( make( gen, i * 10, i * 10 + 5 ) );
+        }
+
+        std::vector<ival_type> keys;
+        std::uniform_int_distribution<u64> ud( 0, count * 10 );
+        for( std::size_t i = 0; i < ( 1 << 18 ); i++ ) {
+            auto v = ud( gen );
+            keys.push_back( make( gen, v, v + 3 ) );
+        }
+
+        std::cout << count << " elements\n";
+        run( "    less_attrs  ", arr, keys,
+             [ ]( const ival_type &lh, const ival_type &rh ) {
+                 return cmp::less_attrs( lh, rh );
+             } );
+        run( "    less_encoded", arr, keys,
+             [ ]( const ival_type &lh, const ival_type &rh ) {
+                 return cmp::less_encoded( lh, rh );
+             } );
+        run( "    less        ", arr, keys, cmp( ) );
+    }
+}
+
+int main( )
+{
+    run_all( 1 << 12 );
+    run_all( 1 << 20 );
+    return 0;
+}
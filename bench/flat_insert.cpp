@@ -0,0 +1,128 @@
+/// insert-heavy workloads of the flat containers: the keys come in
+/// random order, so every insert shifts a half of the array on average.
+/// The relocatable values are shifted by memmove, the others
+/// element by element
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "intervals/set.h"
+#include "intervals/map.h"
+
+namespace {
+
+    using u64       = std::uint64_t;
+    using ival_type = intervals::interval<u64>;
+    using clock     = std::chrono::steady_clock;
+
+    /// an int that isn't trivially copyable
+    struct boxed {
+        int v = 0;
+        boxed( ) = default;
+        boxed( int val )
+            :v(val)
+        { }
+        boxed( const boxed &other )
+            :v(other.v)
+        { }
+        boxed &operator = ( const boxed &other )
+        {
+            v = other.v;
+            return *this;
+        }
+    };
+
+    std::vector<ival_type> make_keys( std::size_t count )
+    {
+        std::vector<ival_type> keys;
+        for( u64 i = 0; i < count; i++ ) {
+            keys.push_back( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+        std::shuffle( keys.begin( ), keys.end( ), std::mt19937_64( 1 ) );
+        return keys;
+    }
+
+    template <typename FuncT>
+    void report( const char *name, std::size_t count, FuncT fn )
+    {
+        auto start = clock::now( );
+        std::size_t sink = fn( );
+        std::chrono::duration<double, std::nano> spent = clock::now( )
+                                                       - start;
+        std::cout << name << ": " << spent.count( ) / count
+                  << " ns per insert (" << sink << ")\n";
+    }
+
+    /// the shift alone: sorted inserts into a plain vector
+    template <typename ValueT, typename RelocT>
+    std::size_t shift_inserts( const std::vector<ival_type> &keys,
+                               const ValueT &proto, RelocT reloc )
+    {
+        using cmp = ival_type::cmp_not_overlap;
+        std::vector<std::pair<ival_type, ValueT> > arr;
+        for( auto &k: keys ) {
+            auto where = std::lower_bound( arr.begin( ), arr.end( ), k,
+                [ ]( const std::pair<ival_type, ValueT> &lh,
+                     const ival_type &rh ) {
+                    return cmp::less( lh.first, rh );
+                } );
+            intervals::detail::array_insert( arr, where,
+                                             std::make_pair( k, proto ),
+                                             reloc );
+        }
+        return arr.size( );
+    }
+
+    template <typename MapT>
+    std::size_t map_inserts( const std::vector<ival_type> &keys )
+    {
+        MapT m;
+        int i = 0;
+        for( auto &k: keys ) {
+            m.insert( std::make_pair( k, typename MapT::mapped_type( i++ ) ) );
+        }
+        return m.size( );
+    }
+
+    std::size_t set_inserts( const std::vector<ival_type> &keys )
+    {
+        intervals::flat_set<u64> s;
+        for( auto &k: keys ) {
+            s.insert( k );
+        }
+        return s.size( );
+    }
+
+    void run_all( std::size_t count )
+    {
+        auto keys = make_keys( count );
+        std::cout << count << " random inserts\n";
+
+        report( "    vector shift, memmove      ", count, [&]( ) {
+            return shift_inserts( keys, 0, std::true_type( ) );
+        } );
+        report( "    vector shift, element-wise ", count, [&]( ) {
+            return shift_inserts( keys, 0, std::false_type( ) );
+        } );
+        report( "    flat_map<u64, int>         ", count, [&]( ) {
+            return map_inserts<intervals::flat_map<u64, int> >( keys );
+        } );
+        report( "    flat_map<u64, boxed>       ", count, [&]( ) {
+            return map_inserts<intervals::flat_map<u64, boxed> >( keys );
+        } );
+        report( "    flat_set<u64>              ", count, [&]( ) {
+            return set_inserts( keys );
+        } );
+    }
+}
+
+int main( )
+{
+    run_all( 1 << 12 );
+    run_all( 1 << 16 );
+    return 0;
+}
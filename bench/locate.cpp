@@ -0,0 +1,136 @@
+/// counts comparisons of the domain values needed to locate an interval.
+/// two searches ('lower_bound' + 'upper_bound') vs one 'equal_range'
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "intervals/set.h"
+
+namespace {
+
+    using u64 = std::uint64_t;
+
+    std::size_t compared = 0;
+
+    /// u64 that counts its comparisons
+    struct number {
+        u64 v = 0;
+        number( ) = default;
+        number( u64 val )
+            :v(val)
+        { }
+    };
+
+    bool operator < ( const number &lh, const number &rh )
+    {
+        ++compared;
+        return lh.v < rh.v;
+    }
+
+    bool operator <= ( const number &lh, const number &rh )
+    {
+        ++compared;
+        return lh.v <= rh.v;
+    }
+
+    bool operator == ( const number &lh, const number &rh )
+    {
+        ++compared;
+        return lh.v == rh.v;
+    }
+
+    using ival_type = intervals::interval<number>;
+    using cmp_type  = ival_type::cmp_not_overlap;
+    using std_type  = std::set<ival_type, cmp_type>;
+    using arr_type  = intervals::traits::array_set<number, std::less<number>,
+                                        std::allocator<ival_type> >
+                                        ::container_type;
+
+    template <typename ContT>
+    void run_bounds( const char *name, const ContT &cont,
+                     const std::vector<ival_type> &keys )
+    {
+        compared = 0;
+        std::size_t sink = 0;
+        for( auto &k: keys ) {
+            auto lb = cont.lower_bound( k );
+            auto ub = cont.upper_bound( k );
+            sink += (lb == ub);
+        }
+        double two = double(compared) / keys.size( );
+
+        compared = 0;
+        for( auto &k: keys ) {
+            auto r = cont.equal_range( k );
+            sink += (r.first == r.second);
+        }
+        double one = double(compared) / keys.size( );
+
+        std::cout << name << "\n"
+                  << "    lower_bound + upper_bound: " << two << "\n"
+                  << "    equal_range:               " << one << "\n"
+                  << "    (" << sink << ")\n";
+    }
+
+    template <typename SetT>
+    void run_tree( const char *name, const std::vector<ival_type> &keys )
+    {
+        SetT iset;
+        for( u64 i = 0; i < keys.size( ); i++ ) {
+            iset.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+
+        compared = 0;
+        std::size_t found = 0;
+        for( auto &k: keys ) {
+            found += ( iset.find( k ) != iset.end( ) );
+        }
+        double find = double(compared) / keys.size( );
+
+        compared = 0;
+        for( auto &k: keys ) {
+            iset.insert( k );
+        }
+        double insert = double(compared) / keys.size( );
+
+        std::cout << name << "\n"
+                  << "    find:   " << find << "\n"
+                  << "    insert: " << insert << "\n"
+                  << "    (" << found << ")\n";
+    }
+}
+
+int main( )
+{
+    const std::size_t count = 1 << 16;
+
+    std::mt19937_64 gen( 1 );
+    std::uniform_int_distribution<u64> ud( 0, count * 10 );
+
+    std_type cont;
+    arr_type arr;
+    for( u64 i = 0; i < count; i++ ) {
+        auto k = ival_type::left_closed( i * 10, i * 10 + 5 );
+        cont.insert( k );
+        arr.arr_.push_back( k );
+    }
+
+    std::vector<ival_type> keys;
+    for( std::size_t i = 0; i < count; i++ ) {
+        auto v = ud( gen );
+        keys.push_back( ival_type::left_closed( v, v + 3 ) );
+    }
+
+    std::cout << "domain comparisons per call; "
+              << count << " elements\n\n";
+
+    run_bounds( "std::set", cont, keys );
+    run_bounds( "sorted array", arr, keys );
+
+    run_tree<intervals::set<number> >( "intervals::set", keys );
+    run_tree<intervals::flat_set<number> >( "intervals::flat_set", keys );
+
+    return 0;
+}
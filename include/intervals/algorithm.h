@@ -0,0 +1,183 @@
+#ifndef ETOOL_INTERVALS_ALGORITHM_H
+#define ETOOL_INTERVALS_ALGORITHM_H
+
+#include <functional>
+#include <utility>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    namespace detail {
+
+        /// Appends the elements to the end of a map.
+        /// With 'coalesce' a piece that is connected to the previous one
+        /// and has an equal value extends it
+        template <typename MapT, typename EqualT>
+        class map_appender {
+
+        public:
+
+            using key_type    = typename MapT::key_type;
+            using mapped_type = typename MapT::mapped_type;
+
+            map_appender( MapT &res, EqualT &equal, bool coalesce )
+                :res_(res)
+                ,equal_(equal)
+                ,coalesce_(coalesce)
+            { }
+
+            void operator ( )( const key_type &key, const mapped_type &val )
+            {
+                if( key.empty( ) ) {
+                    return;
+                }
+                if( has_last_ ) {
+                    if( coalesce_ && key.left_connected( last_.first )
+                     && equal_( last_.second, val ) )
+                    {
+                        last_.first.replace_right( key );
+                        return;
+                    }
+                    flush( );
+                }
+                last_.first  = key;
+                last_.second = val;
+                has_last_ = true;
+            }
+
+            void flush( )
+            {
+                if( has_last_ ) {
+                    res_.insert( res_.end( ), std::move(last_) );
+                    has_last_ = false;
+                }
+            }
+
+        private:
+            MapT                              &res_;
+            EqualT                            &equal_;
+            bool                               coalesce_;
+            bool                               has_last_ = false;
+            std::pair<key_type, mapped_type>   last_;
+        };
+
+        template <typename MapT, typename ResolveT, typename EqualT>
+        MapT merge_maps( const MapT &a, const MapT &b, ResolveT &resolve,
+                         EqualT &equal, bool coalesce )
+        {
+            using key_type = typename MapT::key_type;
+
+            MapT res;
+            map_appender<MapT, EqualT> out( res, equal, coalesce );
+
+            auto ia = a.begin( );
+            auto ib = b.begin( );
+
+            /// the rest of the current element of each map
+            key_type ka;
+            key_type kb;
+            if( ia != a.end( ) ) {
+                ka = ia->first;
+            }
+            if( ib != b.end( ) ) {
+                kb = ib->first;
+            }
+
+            auto next_a = [&]( ) {
+                if( ++ia != a.end( ) ) {
+                    ka = ia->first;
+                }
+            };
+
+            auto next_b = [&]( ) {
+                if( ++ib != b.end( ) ) {
+                    kb = ib->first;
+                }
+            };
+
+            using cmp = typename key_type::cmp_not_overlap;
+
+            while( ia != a.end( ) && ib != b.end( ) ) {
+
+                if( cmp::less( ka, kb ) ) {
+                    out( ka, ia->second );
+                    next_a( );
+                    continue;
+                }
+                if( cmp::less( kb, ka ) ) {
+                    out( kb, ib->second );
+                    next_b( );
+                    continue;
+                }
+
+                /// the parts before the common piece
+                if( ka.contains_left( kb ) ) {
+                    out( ka.connect_right( kb ), ia->second );
+                    ka.replace_left( kb );
+                } else if( kb.contains_left( ka ) ) {
+                    out( kb.connect_right( ka ), ib->second );
+                    kb.replace_left( ka );
+                }
+
+                if( ka.contains_right( kb ) ) {
+                    out( kb, resolve( ia->second, ib->second ) );
+                    key_type tail = ka.connect_left( kb );
+                    next_b( );
+                    if( tail.empty( ) ) {
+                        next_a( );
+                    } else {
+                        ka = std::move(tail);
+                    }
+                } else {
+                    out( ka, resolve( ia->second, ib->second ) );
+                    key_type tail = kb.connect_left( ka );
+                    next_a( );
+                    if( tail.empty( ) ) {
+                        next_b( );
+                    } else {
+                        kb = std::move(tail);
+                    }
+                }
+            }
+
+            for( ; ia != a.end( ); next_a( ) ) {
+                out( ka, ia->second );
+            }
+            for( ; ib != b.end( ); next_b( ) ) {
+                out( kb, ib->second );
+            }
+            out.flush( );
+
+            return res;
+        }
+    }
+
+    /// Merges two maps with one walk over both.
+    /// The elements are split at every endpoint; the overlapped pieces
+    /// get 'resolve(value_of_a, value_of_b)', the others keep their values.
+    /// The result is appended in order, so it takes linear time
+    template <typename MapT, typename ResolveT>
+    MapT merge_maps( const MapT &a, const MapT &b, ResolveT resolve )
+    {
+        std::equal_to<typename MapT::mapped_type> equal;
+        return detail::merge_maps( a, b, resolve, equal, false );
+    }
+
+    /// the same but the connected pieces with equal values are fused
+    template <typename MapT, typename ResolveT, typename EqualT>
+    MapT merge_maps( const MapT &a, const MapT &b, ResolveT resolve,
+                     EqualT equal )
+    {
+        return detail::merge_maps( a, b, resolve, equal, true );
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // ALGORITHM_H
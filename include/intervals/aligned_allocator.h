@@ -0,0 +1,75 @@
+#ifndef ETOOL_INTERVALS_ALIGNED_ALLOCATOR_H
+#define ETOOL_INTERVALS_ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// The size of a cache line; the per-thread slots are aligned to it
+    /// so the threads don't write to the same line
+    constexpr std::size_t cache_line_size = 64;
+
+    /// Allocator that respects 'alignof(T)' above the alignment
+    /// of 'operator new', which C++11 containers don't do by themselves.
+    /// The block is taken a bit bigger, the result is aligned inside it
+    /// and the original pointer is kept right before the result
+    template <typename T>
+    struct aligned_allocator {
+
+        using value_type = T;
+
+        aligned_allocator( ) = default;
+
+        template <typename OtherT>
+        aligned_allocator( const aligned_allocator<OtherT> & )
+        { }
+
+        T *allocate( std::size_t n )
+        {
+            const std::size_t align = alignof(T);
+            const std::size_t extra = align + sizeof(void *);
+            char *raw = static_cast<char *>(
+                            ::operator new( n * sizeof(T) + extra ) );
+
+            std::uintptr_t addr =
+                    reinterpret_cast<std::uintptr_t>( raw + sizeof(void *) );
+            addr = ( addr + align - 1 ) & ~std::uintptr_t( align - 1 );
+
+            void **res = reinterpret_cast<void **>( addr );
+            res[-1] = raw;
+            return reinterpret_cast<T *>( res );
+        }
+
+        void deallocate( T *ptr, std::size_t )
+        {
+            ::operator delete( reinterpret_cast<void **>( ptr )[-1] );
+        }
+    };
+
+    template <typename LeftT, typename RightT>
+    bool operator == ( const aligned_allocator<LeftT> &,
+                       const aligned_allocator<RightT> & )
+    {
+        return true;
+    }
+
+    template <typename LeftT, typename RightT>
+    bool operator != ( const aligned_allocator<LeftT> &,
+                       const aligned_allocator<RightT> & )
+    {
+        return false;
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // ALIGNED_ALLOCATOR_H
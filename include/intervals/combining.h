@@ -0,0 +1,295 @@
+#ifndef ETOOL_INTERVALS_COMBINING_H
+#define ETOOL_INTERVALS_COMBINING_H
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "intervals/aligned_allocator.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Flat combining front end for a set or a map.
+    /// Every thread posts its mutation to its own slot; the thread
+    /// that takes the lock becomes the combiner: it collects the posted
+    /// mutations, sorts them by the left bound and applies them in one
+    /// pass. The node based backends take the hinted calls; the sorted
+    /// array backends are rebuilt once per batch, so the tail
+    /// of the array is not shifted for every call.
+    /// So the lock changes hands once per batch instead of once per call.
+    /// Concurrent calls are applied in the key order;
+    /// calls of one thread keep their order.
+    template <typename TreeT>
+    class combining {
+
+    public:
+
+        using tree_type         = TreeT;
+        using key_type          = typename tree_type::key_type;
+        using value_type        = typename tree_type::value_type;
+        using iterator          = typename tree_type::iterator;
+        using const_iterator    = typename tree_type::const_iterator;
+        using iterator_access   = typename tree_type::iterator_access;
+
+    private:
+
+        enum class operation { INSERT, MERGE, ABSORB, CUT };
+
+        enum state_type { IDLE, POSTED, DONE };
+
+        /// every slot has its own cache line
+        struct alignas(cache_line_size) slot {
+            std::atomic<bool>   used{ false };
+            std::atomic<int>    state{ IDLE };
+            operation           op = operation::INSERT;
+            value_type         *val = nullptr;
+            const key_type     *key = nullptr;
+            key_type            result;
+        };
+
+    public:
+
+        /// The slot of one thread. Calls block until a combiner
+        /// (this thread or another one) has applied the mutation.
+        /// They return the element that holds the value afterwards
+        class handle {
+
+        public:
+
+            handle( handle &&other )
+                :owner_(other.owner_)
+                ,slot_(other.slot_)
+            {
+                other.slot_ = nullptr;
+            }
+
+            handle( const handle & ) = delete;
+            handle &operator = ( const handle & ) = delete;
+            handle &operator = ( handle && ) = delete;
+
+            ~handle( )
+            {
+                if( slot_ ) {
+                    slot_->used.store( false );
+                }
+            }
+
+            key_type insert( value_type val )
+            {
+                return owner_->run( *slot_, operation::INSERT, &val );
+            }
+
+            key_type merge( value_type val )
+            {
+                return owner_->run( *slot_, operation::MERGE, &val );
+            }
+
+            key_type absorb( value_type val )
+            {
+                return owner_->run( *slot_, operation::ABSORB, &val );
+            }
+
+            void cut( const key_type &key )
+            {
+                owner_->run( *slot_, operation::CUT, nullptr, &key );
+            }
+
+        private:
+
+            friend class combining;
+
+            handle( combining *owner, slot *s )
+                :owner_(owner)
+                ,slot_(s)
+            { }
+
+            combining *owner_;
+            slot      *slot_;
+        };
+
+        explicit combining( std::size_t max_threads = 64 )
+            :slots_(max_threads)
+        {
+            batch_.reserve( max_threads );
+        }
+
+        combining( const combining & ) = delete;
+        combining &operator = ( const combining & ) = delete;
+
+        /// takes a free slot for the calling thread
+        handle attach( )
+        {
+            for( std::size_t i = 0; i < slots_.size( ); i++ ) {
+                bool expected = false;
+                if( slots_[i].used.compare_exchange_strong( expected, true ) ) {
+                    std::size_t top = top_.load( );
+                    while( top <= i
+                       && !top_.compare_exchange_weak( top, i + 1 ) )
+                    { }
+                    return handle( this, &slots_[i] );
+                }
+            }
+            throw std::length_error( "Combining. Too many threads." );
+        }
+
+        /// calls 'fn(const tree_type &)' under the lock
+        template <typename FuncT>
+        void visit( FuncT fn ) const
+        {
+            std::lock_guard<std::mutex> lck(lock_);
+            fn( static_cast<const tree_type &>(tree_) );
+        }
+
+    private:
+
+        key_type run( slot &s, operation op,
+                      value_type *val, const key_type *key = nullptr )
+        {
+            s.op  = op;
+            s.val = val;
+            s.key = key;
+            s.state.store( POSTED, std::memory_order_release );
+
+            while( s.state.load( std::memory_order_acquire ) != DONE ) {
+                if( lock_.try_lock( ) ) {
+                    combine( );
+                    lock_.unlock( );
+                } else {
+                    std::this_thread::yield( );
+                }
+            }
+            s.state.store( IDLE, std::memory_order_relaxed );
+            return std::move(s.result);
+        }
+
+        static const key_type &slot_key( const slot *s )
+        {
+            return s->op == operation::CUT
+                 ? *s->key
+                 : iterator_access::key( *s->val );
+        }
+
+        void combine( )
+        {
+            using cmp = typename key_type::cmp;
+
+            batch_.clear( );
+            const std::size_t top = top_.load( );
+            for( std::size_t i = 0; i < top; i++ ) {
+                slot &s = slots_[i];
+                if( s.state.load( std::memory_order_acquire ) == POSTED ) {
+                    batch_.push_back( &s );
+                }
+            }
+
+            std::stable_sort( batch_.begin( ), batch_.end( ),
+                [ ]( const slot *lh, const slot *rh ) {
+                    return cmp::less_left( slot_key( lh ), slot_key( rh ) );
+                } );
+
+            using category = typename std::iterator_traits<
+                                          iterator>::iterator_category;
+            apply_batch( category( ) );
+        }
+
+        static iterator apply( tree_type &tree, const_iterator hint,
+                               slot &s )
+        {
+            switch( s.op ) {
+            case operation::INSERT:
+                return tree.insert( hint, std::move(*s.val) );
+            case operation::MERGE:
+                return tree.merge( hint, std::move(*s.val) );
+            case operation::ABSORB:
+                return tree.absorb( hint, std::move(*s.val) );
+            default:
+                return tree.cut( hint, *s.key );
+            }
+        }
+
+        static void complete( const tree_type &tree, iterator res, slot &s )
+        {
+            s.result = ( res != tree.end( ) )
+                     ? iterator_access::key( res )
+                     : key_type( );
+            s.state.store( DONE, std::memory_order_release );
+        }
+
+        /// the node based backends: one hinted call per mutation
+        template <typename CategoryT>
+        void apply_batch( CategoryT )
+        {
+            const_iterator hint = tree_.begin( );
+            for( auto s: batch_ ) {
+                iterator res = apply( tree_, hint, *s );
+                hint = res;
+                complete( tree_, res, *s );
+            }
+        }
+
+        /// The sorted arrays: the elements are moved to a new tree
+        /// in one walk. A call sees all the elements it can touch
+        /// (the overlapped and the connected ones) at the end of the new
+        /// tree with the runs of the connected elements after them,
+        /// so it changes only the tail there
+        void apply_batch( std::random_access_iterator_tag )
+        {
+            using I    = iterator_access;
+            using less = typename key_type::cmp_not_overlap;
+
+            tree_type res;
+            auto src  = tree_.begin( );
+            auto last = tree_.end( );
+
+            auto move_one = [&res, &src]( ) {
+                res.insert( res.end( ), std::move(I::mutable_val(src)) );
+                ++src;
+            };
+
+            /// 'absorb' fuses whole runs of the connected elements
+            auto touches = [&res]( const key_type &key,
+                                   const key_type &elem ) {
+                return !less( )( key, elem )
+                    || key.right_connected( elem )
+                    || ( !res.empty( )
+                      && I::key(std::prev(res.end( )))
+                                            .right_connected( elem ) );
+            };
+
+            for( auto s: batch_ ) {
+                const key_type &key = slot_key( s );
+                while( src != last && touches( key, I::key(src) ) ) {
+                    move_one( );
+                }
+                complete( res, apply( res, res.end( ), *s ), *s );
+            }
+            while( src != last ) {
+                move_one( );
+            }
+            tree_ = std::move(res);
+        }
+
+        tree_type                tree_;
+        std::vector<slot, aligned_allocator<slot> > slots_;
+        std::vector<slot *>      batch_;
+        /// slots above it have never been attached
+        std::atomic<std::size_t> top_{ 0 };
+        mutable std::mutex       lock_;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // COMBINING_H
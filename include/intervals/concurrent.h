@@ -0,0 +1,255 @@
+#ifndef ETOOL_INTERVALS_CONCURRENT_H
+#define ETOOL_INTERVALS_CONCURRENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "intervals/aligned_allocator.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Read-copy-update wrapper for a set or a map.
+    /// Every reader thread attaches once and gets its own slot.
+    /// Taking a snapshot is wait-free: the reader writes the current
+    /// epoch to its slot and loads the published pointer; no lock
+    /// and no shared counter are touched. The snapshot gives
+    /// the whole const API and stays valid while it's held.
+    /// Writers are serialized: a writer copies the current version,
+    /// changes the copy, publishes it with one atomic store
+    /// and retires the old version with the current epoch.
+    /// A retired version is freed by a later writer once every
+    /// reader that holds a snapshot has announced a newer epoch.
+    /// Every write copies the tree, so group the mutations with 'update'
+    template <typename TreeT>
+    class concurrent {
+
+        struct alignas(cache_line_size) slot {
+            std::atomic<bool>           used{ false };
+            /// the epoch of the oldest snapshot of the reader; 0 is none
+            std::atomic<std::uint64_t>  epoch{ 0 };
+            /// the snapshots the reader holds; only the reader uses it
+            std::size_t                 depth = 0;
+        };
+
+        struct retired {
+            std::uint64_t    epoch;
+            const TreeT     *tree;
+        };
+
+    public:
+
+        using tree_type = TreeT;
+
+        /// The version a reader holds; it can be moved but not copied.
+        /// It must not outlive its reader
+        class snapshot_type {
+
+        public:
+
+            snapshot_type( snapshot_type &&other )
+                :slot_(other.slot_)
+                ,tree_(other.tree_)
+            {
+                other.slot_ = nullptr;
+            }
+
+            snapshot_type( const snapshot_type & ) = delete;
+            snapshot_type &operator = ( const snapshot_type & ) = delete;
+            snapshot_type &operator = ( snapshot_type && ) = delete;
+
+            ~snapshot_type( )
+            {
+                if( slot_ && --slot_->depth == 0 ) {
+                    slot_->epoch.store( 0, std::memory_order_release );
+                }
+            }
+
+            const tree_type &operator * ( ) const
+            {
+                return *tree_;
+            }
+
+            const tree_type *operator -> ( ) const
+            {
+                return tree_;
+            }
+
+            const tree_type *get( ) const
+            {
+                return tree_;
+            }
+
+        private:
+
+            friend class concurrent;
+
+            snapshot_type( slot *s, const tree_type *tree )
+                :slot_(s)
+                ,tree_(tree)
+            { }
+
+            slot            *slot_;
+            const tree_type *tree_;
+        };
+
+        /// The slot of one reader thread
+        class reader {
+
+        public:
+
+            reader( reader &&other )
+                :owner_(other.owner_)
+                ,slot_(other.slot_)
+            {
+                other.slot_ = nullptr;
+            }
+
+            reader( const reader & ) = delete;
+            reader &operator = ( const reader & ) = delete;
+            reader &operator = ( reader && ) = delete;
+
+            ~reader( )
+            {
+                if( slot_ ) {
+                    slot_->used.store( false );
+                }
+            }
+
+            /// wait-free
+            snapshot_type snapshot( )
+            {
+                if( slot_->depth++ == 0 ) {
+                    slot_->epoch.store( owner_->epoch_.load( ) );
+                }
+                return snapshot_type( slot_, owner_->current_.load( ) );
+            }
+
+        private:
+
+            friend class concurrent;
+
+            reader( const concurrent *owner, slot *s )
+                :owner_(owner)
+                ,slot_(s)
+            { }
+
+            const concurrent *owner_;
+            slot             *slot_;
+        };
+
+        explicit concurrent( std::size_t max_readers = 64 )
+            :concurrent(tree_type( ), max_readers)
+        { }
+
+        explicit concurrent( tree_type init, std::size_t max_readers = 64 )
+            :slots_(max_readers)
+            ,current_(new tree_type( std::move(init) ))
+        { }
+
+        concurrent( const concurrent & ) = delete;
+        concurrent &operator = ( const concurrent & ) = delete;
+
+        /// all the readers must be gone
+        ~concurrent( )
+        {
+            for( auto &r: retired_ ) {
+                delete r.tree;
+            }
+            delete current_.load( );
+        }
+
+        /// takes a free slot for the calling thread
+        reader attach( ) const
+        {
+            for( auto &s: slots_ ) {
+                bool expected = false;
+                if( s.used.compare_exchange_strong( expected, true ) ) {
+                    return reader( this, &s );
+                }
+            }
+            throw std::length_error( "Concurrent. Too many readers." );
+        }
+
+        /// Calls 'change(tree &)' on a copy of the current version
+        /// and publishes the copy
+        template <typename ChangeT>
+        void update( ChangeT change )
+        {
+            std::lock_guard<std::mutex> lck(write_lock_);
+
+            const tree_type *old = current_.load( );
+            std::unique_ptr<tree_type> next(new tree_type( *old ));
+            change( *next );
+
+            retired_.reserve( retired_.size( ) + 1 );
+            current_.store( next.release( ) );
+            retired_.push_back( retired { epoch_.load( ), old } );
+            epoch_.fetch_add( 1 );
+            ++version_;
+
+            reclaim( );
+        }
+
+        /// the number of the published updates
+        std::size_t version( ) const
+        {
+            return version_.load( );
+        }
+
+        /// the old versions that still wait for their readers
+        std::size_t retired_count( ) const
+        {
+            std::lock_guard<std::mutex> lck(write_lock_);
+            return retired_.size( );
+        }
+
+    private:
+
+        /// frees the versions retired before the oldest snapshot
+        void reclaim( )
+        {
+            std::uint64_t oldest = epoch_.load( );
+            for( auto &s: slots_ ) {
+                std::uint64_t e = s.epoch.load( );
+                if( e != 0 && e < oldest ) {
+                    oldest = e;
+                }
+            }
+
+            auto keep = retired_.begin( );
+            for( auto &r: retired_ ) {
+                if( r.epoch < oldest ) {
+                    delete r.tree;
+                } else {
+                    *keep++ = r;
+                }
+            }
+            retired_.erase( keep, retired_.end( ) );
+        }
+
+        using slot_list = std::vector<slot, aligned_allocator<slot> >;
+
+        mutable slot_list               slots_;
+        std::atomic<const tree_type *>  current_;
+        std::atomic<std::uint64_t>      epoch_{ 1 };
+        std::vector<retired>            retired_;
+        mutable std::mutex              write_lock_;
+        std::atomic<std::size_t>        version_{ 0 };
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // CONCURRENT_H
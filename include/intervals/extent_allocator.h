@@ -0,0 +1,267 @@
+#ifndef ETOOL_INTERVALS_EXTENT_ALLOCATOR_H
+#define ETOOL_INTERVALS_EXTENT_ALLOCATOR_H
+
+#include <iterator>
+#include <limits>
+#include <set>
+#include <type_traits>
+
+#include "intervals/set.h"
+#include "intervals/traits/extent_set.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    enum class fit {
+        FIRST,  /// the lowest address
+        BEST,   /// the shortest free extent
+        NEXT,   /// the lowest address after the previous allocation
+    };
+
+    /// Hands out half-open extents [a, b) from the free space.
+    /// The free extents are kept in a set where every subtree knows
+    /// its longest extent, so the search skips the subtrees that
+    /// are too short: first and next fit are O(log n) if 'align' is 1.
+    /// Best fit takes the shortest long enough extent from a second
+    /// index ordered by length and address; it is O(log n) if 'align' is 1.
+    /// An infinite end is as long as the domain allows.
+    /// 'release' returns an extent with 'absorb',
+    /// so the connected free extents are fused
+    template <typename KeyT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<KeyT> >
+    class extent_allocator {
+
+        static_assert( std::is_unsigned<KeyT>::value,
+                       "extent_allocator needs an unsigned domain" );
+
+        using trait_type  = traits::extent_set<KeyT, Comp, AllocT>;
+        using policy_type = typename trait_type::policy_type;
+
+    public:
+
+        using domain_type   = KeyT;
+        using set_type      = set<KeyT, Comp, AllocT, trait_type>;
+        using key_type      = typename set_type::key_type;
+
+        extent_allocator( ) = default;
+
+        explicit extent_allocator( const key_type &space )
+        {
+            release( space );
+        }
+
+        /// returns an empty interval if there is no room
+        key_type allocate( domain_type len, domain_type align = 1,
+                           fit policy = fit::FIRST )
+        {
+            if( len == domain_type( ) || align == domain_type( ) ) {
+                return none( );
+            }
+
+            auto root  = free_.container( ).root( );
+            bool found = false;
+            domain_type start = domain_type( );
+
+            switch( policy ) {
+            case fit::BEST:
+                found = best_fit( len, align, start );
+                break;
+            case fit::NEXT:
+                found = first_fit( root, len, align, &next_, start )
+                     || first_fit( root, len, align, nullptr, start );
+                break;
+            default:
+                found = first_fit( root, len, align, nullptr, start );
+                break;
+            }
+
+            if( !found ) {
+                return none( );
+            }
+
+            key_type holder = *free_.find( start );
+            key_type extent = key_type::left_closed( start, start + len );
+            by_length_.erase( holder );
+            free_.cut( extent );
+            free_.container( ).refresh( );
+            index( holder );
+            next_ = start + len;
+            return extent;
+        }
+
+        void release( const key_type &extent )
+        {
+            if( extent.empty( ) ) {
+                return;
+            }
+            unindex_touched( extent );
+            free_.absorb( extent );
+            free_.container( ).refresh( );
+            index( extent );
+        }
+
+        /// the longest free extent
+        domain_type largest( ) const
+        {
+            auto root = free_.container( ).root( );
+            return root ? root->data.max_length : domain_type( );
+        }
+
+        const set_type &free_extents( ) const
+        {
+            return free_;
+        }
+
+    private:
+
+        /// the set that lets us reach its nodes
+        class free_set: public set_type {
+        public:
+            using set_type::container;
+        };
+
+        /// the shorter extents first, the equal ones by address
+        struct length_less {
+            bool operator ( )( const key_type &lh, const key_type &rh ) const
+            {
+                domain_type llen = policy_type::length( lh );
+                domain_type rlen = policy_type::length( rh );
+                if( llen != rlen ) {
+                    return llen < rlen;
+                }
+                return typename key_type::cmp_not_overlap( )( lh, rh );
+            }
+        };
+
+        using length_index = std::set<key_type, length_less>;
+
+        template <typename NodeT>
+        static domain_type max_length( const NodeT *n )
+        {
+            return n ? n->data.max_length : domain_type( );
+        }
+
+        static key_type none( )
+        {
+            return key_type::left_closed( domain_type( ), domain_type( ) );
+        }
+
+        /// the free extents inside 'hull' go to the length index
+        void index( const key_type &hull )
+        {
+            auto range = free_.find_intersection( hull );
+            for( ; range.first != range.second; ++range.first ) {
+                by_length_.insert( *range.first );
+            }
+        }
+
+        /// the free extents that 'absorb' fuses with 'extent'
+        /// leave the length index
+        void unindex_touched( const key_type &extent )
+        {
+            auto range = free_.find_intersection( extent );
+            if( range.first != free_.begin( )
+             && extent.left_connected( *std::prev(range.first) ) )
+            {
+                --range.first;
+            }
+            if( range.second != free_.end( )
+             && extent.right_connected( *range.second ) )
+            {
+                ++range.second;
+            }
+            for( ; range.first != range.second; ++range.first ) {
+                by_length_.erase( *range.first );
+            }
+        }
+
+        /// the aligned start of 'len' units inside 'ival' that is not
+        /// less than 'from'
+        static bool fits( const key_type &ival, domain_type len,
+                          domain_type align, const domain_type *from,
+                          domain_type &start )
+        {
+            domain_type pos;
+            domain_type end;
+            policy_type::bounds( ival, pos, end );
+
+            if( from && pos < *from ) {
+                pos = *from;
+            }
+
+            domain_type rem = pos % align;
+            if( rem != domain_type( ) ) {
+                domain_type step = align - rem;
+                if( std::numeric_limits<domain_type>::max( ) - pos < step ) {
+                    return false;
+                }
+                pos += step;
+            }
+
+            if( !( pos < end ) || end - pos < len ) {
+                return false;
+            }
+            start = pos;
+            return true;
+        }
+
+        /// 'ival' has no positions at or after 'pos'
+        static bool ends_before( const key_type &ival, domain_type pos )
+        {
+            domain_type lo;
+            domain_type hi;
+            policy_type::bounds( ival, lo, hi );
+            return !( pos < hi );
+        }
+
+        template <typename NodeT>
+        static const NodeT *first_fit( const NodeT *n, domain_type len,
+                                       domain_type align,
+                                       const domain_type *from,
+                                       domain_type &start )
+        {
+            if( max_length( n ) < len ) {
+                return nullptr;
+            }
+            if( from && ends_before( n->value, *from ) ) {
+                return first_fit( n->right, len, align, from, start );
+            }
+            if( auto res = first_fit( n->left, len, align, from, start ) ) {
+                return res;
+            }
+            if( fits( n->value, len, align, from, start ) ) {
+                return n;
+            }
+            return first_fit( n->right, len, align, from, start );
+        }
+
+        /// the first long enough extent of the index is the best one;
+        /// the alignment can make us skip a few of them
+        bool best_fit( domain_type len, domain_type align,
+                       domain_type &start ) const
+        {
+            auto probe = key_type::left_closed( domain_type( ), len );
+            auto itr   = by_length_.lower_bound( probe );
+            for( ; itr != by_length_.end( ); ++itr ) {
+                if( fits( *itr, len, align, nullptr, start ) ) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        free_set     free_;
+        length_index by_length_;
+        domain_type  next_ = domain_type( );
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // EXTENT_ALLOCATOR_H
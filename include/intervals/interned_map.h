@@ -0,0 +1,185 @@
+#ifndef ETOOL_INTERVALS_INTERNED_MAP_H
+#define ETOOL_INTERVALS_INTERNED_MAP_H
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "intervals/map.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Keeps every distinct value once and gives it a small handle.
+    /// Handles are stable; values are never removed
+    template <typename ValueT, typename HashT = std::hash<ValueT>,
+              typename EqualT = std::equal_to<ValueT> >
+    class value_dictionary {
+
+    public:
+
+        using value_type    = ValueT;
+        using handle_type   = std::uint32_t;
+
+        value_dictionary( ) = default;
+        value_dictionary( value_dictionary && ) = default;
+        value_dictionary &operator = ( value_dictionary && ) = default;
+
+        value_dictionary( const value_dictionary &other )
+            :index_(other.index_)
+        {
+            rebuild( );
+        }
+
+        value_dictionary &operator = ( const value_dictionary &other )
+        {
+            value_dictionary tmp(other);
+            std::swap( index_,  tmp.index_ );
+            std::swap( values_, tmp.values_ );
+            return *this;
+        }
+
+        handle_type intern( const value_type &val )
+        {
+            if( values_.size( ) == std::numeric_limits<handle_type>::max( ) ) {
+                throw std::length_error( "Dictionary. Too many values." );
+            }
+
+            const auto next = static_cast<handle_type>( values_.size( ) );
+            values_.push_back( nullptr );
+            try {
+                auto res = index_.emplace( val, next );
+                if( res.second ) {
+                    values_.back( ) = &res.first->first;
+                } else {
+                    values_.pop_back( );
+                }
+                return res.first->second;
+            } catch( ... ) {
+                values_.pop_back( );
+                throw;
+            }
+        }
+
+        const value_type &value( handle_type handle ) const
+        {
+            return *values_[handle];
+        }
+
+        std::size_t size( ) const
+        {
+            return values_.size( );
+        }
+
+    private:
+
+        /// the keys of the index are the values;
+        /// the pointers have to point to our own copy
+        void rebuild( )
+        {
+            values_.assign( index_.size( ), nullptr );
+            for( auto &v: index_ ) {
+                values_[v.second] = &v.first;
+            }
+        }
+
+        std::unordered_map<value_type, handle_type, HashT, EqualT> index_;
+        std::vector<const value_type *> values_;
+    };
+
+    /// The map that keeps a handle of the value in every element.
+    /// The values live in the dictionary, so splitting an element
+    /// copies only the handle and 'compact' compares integers.
+    /// The elements give handles; 'value' gives the values
+    template <typename KeyT, typename ValueT,
+              typename Comp   = std::less<KeyT>,
+              typename HashT  = std::hash<ValueT>,
+              typename EqualT = std::equal_to<ValueT>,
+              typename AllocT = std::allocator<
+                                  std::pair<const KeyT, std::uint32_t> > >
+    class interned_map: public map<KeyT, std::uint32_t, Comp, AllocT> {
+
+        using parent_type = map<KeyT, std::uint32_t, Comp, AllocT>;
+
+    public:
+
+        using dictionary_type   = value_dictionary<ValueT, HashT, EqualT>;
+        using handle_type       = typename dictionary_type::handle_type;
+        using mapped_value_type = ValueT;
+        using key_type          = typename parent_type::key_type;
+        using iterator          = typename parent_type::iterator;
+        using const_iterator    = typename parent_type::const_iterator;
+
+        using parent_type::insert;
+        using parent_type::merge;
+        using parent_type::absorb;
+
+        iterator insert( const key_type &key, const mapped_value_type &val )
+        {
+            return insert( std::make_pair( key, intern( val ) ) );
+        }
+
+        iterator insert( const_iterator hint, const key_type &key,
+                         const mapped_value_type &val )
+        {
+            return insert( hint, std::make_pair( key, intern( val ) ) );
+        }
+
+        iterator merge( const key_type &key, const mapped_value_type &val )
+        {
+            return merge( std::make_pair( key, intern( val ) ) );
+        }
+
+        iterator merge( const_iterator hint, const key_type &key,
+                        const mapped_value_type &val )
+        {
+            return merge( hint, std::make_pair( key, intern( val ) ) );
+        }
+
+        iterator absorb( const key_type &key, const mapped_value_type &val )
+        {
+            return absorb( std::make_pair( key, intern( val ) ) );
+        }
+
+        iterator absorb( const_iterator hint, const key_type &key,
+                         const mapped_value_type &val )
+        {
+            return absorb( hint, std::make_pair( key, intern( val ) ) );
+        }
+
+        handle_type intern( const mapped_value_type &val )
+        {
+            return dict_.intern( val );
+        }
+
+        const mapped_value_type &value( handle_type handle ) const
+        {
+            return dict_.value( handle );
+        }
+
+        const mapped_value_type &value( const_iterator itr ) const
+        {
+            return dict_.value( itr->second );
+        }
+
+        const dictionary_type &dictionary( ) const
+        {
+            return dict_;
+        }
+
+    private:
+        dictionary_type dict_;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // INTERNED_MAP_H
@@ -0,0 +1,186 @@
+#ifndef ETOOL_INTERVALS_INTERSECTION_VIEW_H
+#define ETOOL_INTERVALS_INTERSECTION_VIEW_H
+
+#include <iterator>
+#include <utility>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    namespace detail {
+
+        /// what a view gives next to the clipped interval:
+        /// the element itself for sets and the mapped value for maps
+        template <typename KeyT, typename ValueT>
+        struct view_mapped {
+            using type = const typename ValueT::second_type &;
+            static type get( const ValueT &val )
+            {
+                return val.second;
+            }
+        };
+
+        template <typename KeyT>
+        struct view_mapped<KeyT, KeyT> {
+            using type = const KeyT &;
+            static type get( const KeyT &val )
+            {
+                return val;
+            }
+        };
+    }
+
+    /// Lazy range of the elements that intersect some interval.
+    /// Dereferencing gives a pair: the element's interval clipped
+    /// to the interval of the view and a reference to the element itself
+    /// for sets or to the mapped value for maps.
+    /// Only the first and the last elements can stick out,
+    /// so only they are clipped. Nothing is copied or allocated.
+    template <typename TraitT>
+    class intersection_view {
+
+    public:
+
+        using trait_type        = TraitT;
+        using key_type          = typename trait_type::interval_type;
+        using value_type        = typename trait_type::value_type;
+        using const_iterator    = typename trait_type::const_iterator;
+        using iterator_access   = typename trait_type::iterator_access;
+
+        using mapped_access     = detail::view_mapped<key_type, value_type>;
+        using element_type      = std::pair<key_type,
+                                            typename mapped_access::type>;
+
+        class iterator {
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = element_type;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = element_type;
+
+            iterator( ) = default;
+
+            element_type operator * ( ) const
+            {
+                using I = iterator_access;
+                const key_type &key = I::key(itr_);
+
+                if( itr_ != parent_->first_ && itr_ != parent_->back_ ) {
+                    return element_type( key,
+                                         mapped_access::get( I::val(itr_) ) );
+                }
+
+                const key_type &bound = parent_->key_;
+                bool left  = ( itr_ == parent_->first_ )
+                          && key.contains_left( bound );
+                bool right = ( itr_ == parent_->back_ )
+                          && key.contains_right( bound );
+
+                return element_type(
+                            key_type::intersection( left  ? bound : key,
+                                                    right ? bound : key ),
+                            mapped_access::get( I::val(itr_) ) );
+            }
+
+            iterator &operator ++ ( )
+            {
+                ++itr_;
+                return *this;
+            }
+
+            iterator operator ++ ( int )
+            {
+                iterator tmp(*this);
+                ++itr_;
+                return tmp;
+            }
+
+            bool operator == ( const iterator &other ) const
+            {
+                return itr_ == other.itr_;
+            }
+
+            bool operator != ( const iterator &other ) const
+            {
+                return itr_ != other.itr_;
+            }
+
+            /// the element in the container
+            const_iterator base( ) const
+            {
+                return itr_;
+            }
+
+        private:
+
+            friend class intersection_view;
+
+            iterator( const intersection_view *parent, const_iterator itr )
+                :parent_(parent)
+                ,itr_(itr)
+            { }
+
+            const intersection_view *parent_ = nullptr;
+            const_iterator           itr_;
+        };
+
+        intersection_view( key_type key,
+                           const_iterator first, const_iterator last )
+            :key_(std::move(key))
+            ,first_(first)
+            ,last_(last)
+            ,back_(first == last ? last : std::prev(last))
+        { }
+
+        /// iterators keep a pointer to the view
+        intersection_view( const intersection_view & ) = delete;
+        intersection_view &operator = ( const intersection_view & ) = delete;
+
+        intersection_view( intersection_view &&other )
+            :key_(std::move(other.key_))
+            ,first_(other.first_)
+            ,last_(other.last_)
+            ,back_(other.back_)
+        { }
+
+        iterator begin( ) const
+        {
+            return iterator( this, first_ );
+        }
+
+        iterator end( ) const
+        {
+            return iterator( this, last_ );
+        }
+
+        bool empty( ) const
+        {
+            return first_ == last_;
+        }
+
+        const key_type &key( ) const
+        {
+            return key_;
+        }
+
+    private:
+
+        key_type       key_;
+        const_iterator first_;
+        const_iterator last_;
+        const_iterator back_;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // INTERSECTION_VIEW_H
@@ -3,10 +3,13 @@
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <sstream>
+#include <type_traits>
 
 #include "intervals/attributes.h"
 #include "intervals/endpoint_type.h"
+#include "intervals/layout.h"
 
 #ifdef INTERVALS_TOP_NANESPACE
 namespace INTERVALS_TOP_NANESPACE {
@@ -172,103 +175,189 @@ namespace intervals {
 
     }
 
-    template <typename DomainT, typename Comparator = std::less<DomainT> >
+    template <typename DomainT, typename Comparator = std::less<DomainT>,
+              typename LayoutT = typename default_layout<DomainT>::type>
     class interval {
 
+        using endpoints_type  = detail::endpoints<DomainT, LayoutT>;
+
     public:
 
         using domain_type     = DomainT;
         using comparator_type = Comparator;
+        using layout_type     = LayoutT;
+        /// 'const domain_type &' or a copy for the packed layout
+        using value_reference = typename endpoints_type::reference;
 
     private:
 
-        template <typename IvalT>
-        static IvalT &check( IvalT &ival )
-        {
-#ifdef DEBUG
-            if( ival.invalid( ) ) {
-                throw std::logic_error( "Invalid value." );
-            }
-#endif
-            return ival;
-        }
+        using discrete = typename discrete_domain<DomainT,
+                                                  Comparator>::type;
 
-    public:
+        /// every interval is [a, b) with the sentinels for the infinities:
+        /// a few methods are single comparisons of the values
+        using fixed_bounds = typename std::is_same<LayoutT,
+                                                   layout::half_open>::type;
 
-        using left_type  = endpoint_type<endpoint_name::LEFT>;
-        using right_type = endpoint_type<endpoint_name::RIGHT>;
+        /// arithmetic values with the natural order
+        using encodable = std::integral_constant<bool,
+                  std::is_arithmetic<domain_type>::value
+               && std::is_same<comparator_type,
+                               std::less<domain_type> >::value>;
 
-        interval( domain_type lh, domain_type rh,
-                  attributes  lf, attributes  rf )
-            :left_(std::move(lh))
-            ,right_(std::move(rh))
+        static_assert( !fixed_bounds::value || encodable::value,
+                       "Half-open layout. The comparator must be std::less." );
+
+        static_assert( !discrete::value
+                    || std::is_integral<domain_type>::value,
+                       "Discrete domain. The domain must be integral." );
+
+        /// How the ends are compared; every method can fall back
+        /// to its base. 'by_attrs' is for every domain and comparator,
+        /// 'by_builtin' uses the operators of the arithmetic domains
+        /// and works in the constant expressions,
+        /// 'by_values' is for the half-open layout
+        struct by_attrs { };
+        struct by_builtin: by_attrs { };
+        struct by_values:  by_builtin { };
+
+        using method = typename std::conditional<fixed_bounds::value,
+                             by_values,
+                             typename std::conditional<encodable::value,
+                                                       by_builtin,
+                                                       by_attrs>::type
+                       >::type;
+
+        static constexpr
+        endpoints_type make_ends( domain_type lh, domain_type rh,
+                                  attributes  lf, attributes  rf,
+                                  std::false_type )
         {
-            attrs_[0] = lf;
-            attrs_[1] = rf;
+            return endpoints_type( detail::move(lh),
+                                   detail::move(rh), lf, rf );
         }
 
-        interval( )
+        /// [a, b) for the discrete domains; the ends that can't be moved
+        /// without an overflow stay as they are. An open left end
+        /// that meets the right one gives the empty [a+1, a+1)
+        static constexpr
+        endpoints_type make_ends( domain_type lh, domain_type rh,
+                                  attributes  lf, attributes  rf,
+                                  std::true_type )
         {
-            attrs_[0] = attributes::MIN_INF;
-            attrs_[1] = attributes::MIN_INF;
+            return meets( lh, rh, lf, rf )
+                 ? endpoints_type( lh + 1, lh + 1,
+                                   attributes::CLOSE, attributes::OPEN )
+                 : endpoints_type( moves_left( lh, lf ) ? lh + 1 : lh,
+                                   canonical_right( rh, rf ),
+                                   moves_left( lh, lf ) ? attributes::CLOSE
+                                                        : lf,
+                                   canonical_right_attr( rh, rf ) );
         }
 
-        interval( const domain_type &val )
-            :left_(val)
-            ,right_(val)
+        /// '(a, b)' with b <= a+1 or '(a, b]' with b <= a
+        static constexpr
+        bool meets( const domain_type &lh, const domain_type &rh,
+                    attributes lf, attributes rf )
         {
-            attrs_[0] = attributes::CLOSE;
-            attrs_[1] = attributes::CLOSE;
+            return moves_left( lh, lf )
+                && canonical_right_attr( rh, rf ) == attributes::OPEN
+                && !( lh + 1 < canonical_right( rh, rf ) );
         }
 
-        interval( const interval &other )
-            :left_ (other.left_)
-            ,right_(other.right_)
+        static constexpr
+        bool moves_left( const domain_type &val, attributes attr )
         {
-            attrs_[0] = other.attrs_[0];
-            attrs_[1] = other.attrs_[1];
+            return ( attr == attributes::OPEN ) && ( val != max_value( ) );
         }
 
-        interval( interval &&other )
-            :left_(std::move(other.left_))
-            ,right_(std::move(other.right_))
+        /// 'b]' is 'b+1)' or +inf
+        static constexpr
+        domain_type canonical_right( const domain_type &val, attributes attr )
         {
-            attrs_[0]  = other.attrs_[0];
-            attrs_[1]  = other.attrs_[1];
+            return ( attr != attributes::CLOSE ) ? val
+                 : ( val  != max_value( ) )      ? val + 1
+                 :                                 domain_type( );
         }
 
-        interval& operator = ( const interval &other )
+        static constexpr
+        attributes canonical_right_attr( const domain_type &val,
+                                         attributes attr )
         {
-            interval tmp(other);
-            swap( tmp );
-            return *this;
+            return ( attr != attributes::CLOSE ) ? attr
+                 : ( val  != max_value( ) )      ? attributes::OPEN
+                 :                                 attributes::MAX_INF;
         }
 
-        interval& operator = ( interval &&other )
+        static constexpr
+        domain_type max_value( )
         {
-            interval tmp(std::move(other));
-            swap( tmp );
-            return *this;
+            return std::numeric_limits<domain_type>::max( );
         }
 
-        ~interval( )
+        template <typename IvalT>
+        static IvalT &check( IvalT &ival )
+        {
+#ifdef DEBUG
+            if( ival.invalid( ) ) {
+                throw std::logic_error( "Invalid value." );
+            }
+#endif
+            return ival;
+        }
+
+    public:
+
+        using left_type  = endpoint_type<endpoint_name::LEFT>;
+        using right_type = endpoint_type<endpoint_name::RIGHT>;
+
+        constexpr
+        interval( domain_type lh, domain_type rh,
+                  attributes  lf, attributes  rf )
+            :ends_(make_ends( detail::move(lh),
+                              detail::move(rh), lf, rf,
+                              discrete( ) ))
+        { }
+
+        constexpr
+        interval( )
+            :ends_(domain_type( ), domain_type( ),
+                   attributes::MIN_INF, attributes::MIN_INF)
         { }
 
-        const domain_type &left( ) const noexcept
+        constexpr
+        interval( const domain_type &val )
+            :ends_(make_ends( val, val, attributes::CLOSE, attributes::CLOSE,
+                              discrete( ) ))
+        { }
+
+        /// all defaulted: the interval is trivially copyable
+        /// if the domain is, and its moves are noexcept if the moves
+        /// of the domain are
+        interval( const interval &other ) = default;
+        interval( interval &&other ) = default;
+        interval& operator = ( const interval &other ) = default;
+        interval& operator = ( interval &&other ) = default;
+
+        constexpr
+        value_reference left( ) const noexcept
         {
             return value<endpoint_name::LEFT>( );
         }
 
-        const domain_type &right( ) const noexcept
+        constexpr
+        value_reference right( ) const noexcept
         {
             return value<endpoint_name::RIGHT>( );
         }
 
+        constexpr
         attributes left_attr( ) const noexcept
         {
             return attrs<endpoint_name::LEFT>( );
         }
 
+        constexpr
         attributes right_attr( ) const noexcept
         {
             return attrs<endpoint_name::RIGHT>( );
@@ -284,7 +373,35 @@ namespace intervals {
             return other.left_connected( *this );
         }
 
+        constexpr
         bool contains( const domain_type &val ) const
+        {
+            return contains_value( val, method( ) );
+        }
+
+    private:
+
+        /// +inf is the max value and holds it
+        constexpr
+        bool contains_value( const domain_type &val, by_values ) const
+        {
+            return ( left( ) <= val )
+                 & ( ( val < right( ) ) | ( right( ) == max_value( ) ) );
+        }
+
+        constexpr
+        bool contains_value( const domain_type &val, by_builtin ) const
+        {
+            return !is_plus_inf<endpoint_name::LEFT>( )
+                && (  is_minus_inf<endpoint_name::LEFT>( )
+                   || ( is_close<endpoint_name::LEFT>( ) ? left( ) <= val
+                                                         : left( ) <  val ) )
+                && (  is_plus_inf<endpoint_name::RIGHT>( )
+                   || ( is_close<endpoint_name::RIGHT>( ) ? val <= right( )
+                                                          : val <  right( ) ) );
+        }
+
+        bool contains_value( const domain_type &val, by_attrs ) const
         {
             if( is_plus_inf<endpoint_name::LEFT>( ) ) {
                 return false;
@@ -300,6 +417,8 @@ namespace intervals {
             return false;
         }
 
+    public:
+
         bool contains_left( const interval &other ) const
         {
             return contains_side<endpoint_name::LEFT>(other);
@@ -318,10 +437,7 @@ namespace intervals {
 
         void swap( interval &other )
         {
-            std::swap( attrs_[0], other.attrs_[0] );
-            std::swap( attrs_[1], other.attrs_[1] );
-            std::swap( left_,     other.left_ );
-            std::swap( right_,    other.right_ );
+            ends_.swap( other.ends_ );
         }
 
         bool not_empty( ) const
@@ -332,13 +448,15 @@ namespace intervals {
                   ;
         }
 
+        constexpr
         bool empty( ) const
         {
             return !has_infinite( )
                  && has_open( )
-                 && cmp::equal( left( ), right( ) );
+                 && equal_ends( method( ) );
         }
 
+        constexpr
         bool is_infinite( ) const
         {
             return is_minus_inf<endpoint_name::LEFT>( )
@@ -346,7 +464,50 @@ namespace intervals {
         }
 
 
+        constexpr
         bool valid( ) const
+        {
+            return valid( method( ) );
+        }
+
+        constexpr
+        bool invalid( ) const
+        {
+            return !valid( );
+        }
+
+    private:
+
+        constexpr
+        bool equal_ends( by_builtin ) const
+        {
+            return left( ) == right( );
+        }
+
+        bool equal_ends( by_attrs ) const
+        {
+            return cmp::equal( left( ), right( ) );
+        }
+
+        /// -inf is the lowest value, so it's just an order of the ends
+        constexpr
+        bool valid( by_values ) const
+        {
+            return left( ) <= right( );
+        }
+
+        constexpr
+        bool valid( by_builtin ) const
+        {
+            return is_minus_inf<endpoint_name::LEFT>( )
+                || ( is_plus_inf<endpoint_name::LEFT>( )
+                   ? is_plus_inf<endpoint_name::RIGHT>( )
+                   : (  is_plus_inf<endpoint_name::RIGHT>( )
+                     || ( !is_minus_inf<endpoint_name::RIGHT>( )
+                        && left( ) <= right( ) ) ) );
+        }
+
+        bool valid( by_attrs ) const
         {
             using u16 = std::uint16_t;
             using A = attributes;
@@ -366,10 +527,7 @@ namespace intervals {
             return false;
         }
 
-        bool invalid( ) const
-        {
-            return !valid( );
-        }
+    public:
 
         interval connect_right( const interval &to ) const
         {
@@ -387,114 +545,112 @@ namespace intervals {
 
         void replace_left( const interval &to )
         {
-            attrs_[0] = to.attrs_[0];
-            left_     = to.left_;
+            ends_.replace_left( to.ends_ );
         }
 
         void replace_right( const interval &to )
         {
-            attrs_[1] = to.attrs_[1];
-            right_    = to.right_;
+            ends_.replace_right( to.ends_ );
         }
 
     public: /// factories
 
-        static
+        static constexpr
         interval open( domain_type lh, domain_type rh )
         {
-            return interval( std::move(lh),     std::move(rh),
-                             attributes::OPEN,  attributes::OPEN );
+            return interval( detail::move(lh), detail::move(rh),
+                             attributes::OPEN, attributes::OPEN );
         }
 
-        static
+        static constexpr
         interval closed( domain_type lh, domain_type rh )
         {
-            return interval( std::move(lh),     std::move(rh),
+            return interval( detail::move(lh),  detail::move(rh),
                              attributes::CLOSE, attributes::CLOSE );
         }
 
-        static
+        static constexpr
         interval degenerate( domain_type lh )
         {
             return interval( lh );
         }
 
-        static
+        static constexpr
         interval infinite(  )
         {
             return interval( domain_type( ),      domain_type( ),
                              attributes::MIN_INF, attributes::MAX_INF);
         }
 
-        static
+        static constexpr
         interval minus_infinite(  )
         {
             return interval( domain_type( ),      domain_type( ),
                              attributes::MIN_INF, attributes::MIN_INF);
         }
 
-        static
+        static constexpr
         interval plus_infinite(  )
         {
             return interval( domain_type( ),      domain_type( ),
                              attributes::MAX_INF, attributes::MAX_INF);
         }
 
-        static
+        static constexpr
         interval left_open( domain_type val )
         {
-            return interval( std::move(val),   domain_type( ),
-                             attributes::OPEN, attributes::MAX_INF);
+            return interval( detail::move(val), domain_type( ),
+                             attributes::OPEN,  attributes::MAX_INF);
         }
 
-        static
+        static constexpr
         interval left_open( domain_type lh, domain_type rh )
         {
-            return interval( std::move(lh),    std::move(rh),
+            return interval( detail::move(lh), detail::move(rh),
                              attributes::OPEN, attributes::CLOSE);
         }
 
-        static
+        static constexpr
         interval right_open( domain_type val )
         {
-            return interval( domain_type( ),      std::move(val),
+            return interval( domain_type( ),      detail::move(val),
                              attributes::MIN_INF, attributes::OPEN );
         }
 
-        static
+        static constexpr
         interval right_open( domain_type lh, domain_type rh )
         {
-            return interval( std::move(lh),     std::move(rh),
+            return interval( detail::move(lh),  detail::move(rh),
                              attributes::CLOSE, attributes::OPEN );
         }
 
-        static
+        static constexpr
         interval left_closed( domain_type val )
         {
-            return interval( std::move(val),    domain_type( ),
+            return interval( detail::move(val), domain_type( ),
                              attributes::CLOSE, attributes::MAX_INF );
         }
 
-        static
+        static constexpr
         interval left_closed( domain_type lh, domain_type rh )
         {
-            return right_open( std::move(lh), std::move(rh) );
+            return right_open( detail::move(lh), detail::move(rh) );
         }
 
-        static
+        static constexpr
         interval right_closed( domain_type val )
         {
-            return interval( domain_type( ),        std::move(val),
+            return interval( domain_type( ),        detail::move(val),
                              attributes::MIN_INF,   attributes::CLOSE );
         }
 
-        static
+        static constexpr
         interval right_closed( domain_type lh, domain_type rh )
         {
-            return left_open( std::move(lh), std::move(rh) );
+            return left_open( detail::move(lh), detail::move(rh) );
         }
 
-        static
+        static constexpr
         interval intersection( const interval &lh, const interval &rh )
         {
             return interval( lh.left( ),      rh.right( ),
@@ -697,6 +853,91 @@ namespace intervals {
                 return ival.empty( );
             }
 
+            /// 'empty( )' without branches: equal values,
+            /// an open end and no infinite ones
+            static constexpr
+            bool empty_bits( const interval &ival )
+            {
+                return ( ( static_cast<std::uint16_t>( ival.left_attr( )
+                                                     | ival.right_attr( ) )
+                         & empty_mask( ) )
+                       == static_cast<std::uint16_t>(attributes::OPEN) )
+                     & ( ival.left( ) == ival.right( ) );
+            }
+
+            static constexpr
+            std::uint16_t empty_mask( )
+            {
+                return static_cast<std::uint16_t>( attributes::MIN_INF
+                                                 | attributes::OPEN
+                                                 | attributes::MAX_INF );
+            }
+
+            /// the empty intervals have their own rules,
+            /// but they change the answer only if the values are equal
+            static constexpr
+            bool less( const interval &lh, const interval &rh, by_builtin )
+            {
+                return ( ( lh.right( ) == rh.left( ) )
+                      && ( empty_bits( lh ) || empty_bits( rh ) ) )
+                     ? less_attrs( lh, rh )
+                     : less_encoded( lh, rh );
+            }
+
+            static
+            bool less( const interval &lh, const interval &rh, by_attrs )
+            {
+                return less_attrs( lh, rh );
+            }
+
+            /// the half-open intervals: the end of 'lh' is not after
+            /// the start of 'rh'. If they are equal, the two empty
+            /// intervals and the infinities are not before each other
+            static constexpr
+            bool less( const interval &lh, const interval &rh, by_values )
+            {
+                return ( lh.right( ) < rh.left( ) )
+                     | ( ( lh.right( ) == rh.left( ) )
+                       & !( ( lh.left( ) == lh.right( ) )
+                          & ( rh.left( ) == rh.right( ) ) )
+                       & ( rh.left( ) != std::numeric_limits<domain_type>
+                                                               ::lowest( ) )
+                       & ( rh.left( ) != max_value( ) ) );
+            }
+
+            /// the kind of an end: -inf 0, a value 1, +inf 2;
+            /// the attribute bits are MIN_INF 1, CLOSE 2, OPEN 4, MAX_INF 8
+            static constexpr
+            unsigned kind( attributes attr )
+            {
+                return ( static_cast<unsigned>(attr) > 1 )
+                     + ( static_cast<unsigned>(attr) > 7 );
+            }
+
+            /// '[a' starts at a, '(a' just after a
+            static constexpr
+            unsigned start_pos( attributes attr )
+            {
+                return ( static_cast<unsigned>(attr) & 6 ) >> 1;
+            }
+
+            /// 'b)' ends just before b, 'b]' at b
+            static constexpr
+            unsigned end_pos( attributes attr )
+            {
+                return ( static_cast<unsigned>(attr) & 2 ) >> 1;
+            }
+
+            static constexpr
+            bool less_keys( unsigned lk, unsigned rk,
+                            value_reference lv, value_reference rv,
+                            unsigned lp, unsigned rp )
+            {
+                return ( lk < rk )
+                     | ( ( lk == 1 ) & ( rk == 1 )
+                       & ( ( lv < rv ) | ( ( lv == rv ) & ( lp < rp ) ) ) );
+            }
+
         public:
 
             static
@@ -706,8 +947,36 @@ namespace intervals {
                         cmp::equal( lh.left( ), rh.left( ) ) );
             }
 
-            static
+            /// 'lh' is entirely before 'rh'.
+            /// The half-open layout compares the values only,
+            /// other arithmetic domains use 'less_encoded' for
+            /// the non-empty intervals, the rest use 'less_attrs'
+            static constexpr
             bool less( const interval &lh, const interval &rh )
+            {
+                return less( lh, rh, method( ) );
+            }
+
+            /// Every endpoint is a key: its kind (-inf, a value, +inf),
+            /// the value and the position around the value (just before,
+            /// at, just after). '[5' starts at 5, '(5' just after 5,
+            /// '5)' ends just before 5 and so on. 'lh' is before 'rh'
+            /// if its end is less than the start of 'rh'. No branches;
+            /// gives the same answers as 'less_attrs' for
+            /// the non-empty intervals
+            static constexpr
+            bool less_encoded( const interval &lh, const interval &rh )
+            {
+                return less_keys( kind( lh.right_attr( ) ),
+                                  kind( rh.left_attr( ) ),
+                                  lh.right( ), rh.left( ),
+                                  end_pos( lh.right_attr( ) ),
+                                  start_pos( rh.left_attr( ) ) );
+            }
+
+            /// the attribute by attribute version for every domain
+            static
+            bool less_attrs( const interval &lh, const interval &rh )
             {
 
                 using EN = endpoint_name;
@@ -785,19 +1054,22 @@ namespace intervals {
         friend struct cmp_not_overlap;
 
         template <endpoint_name Side>
+        constexpr
         bool is_close( ) const
         {
             using S = endpoint_type<Side>;
-            return ( attrs_[S::id] == attributes::CLOSE );
+            return ( ends_.attr( S::id ) == attributes::CLOSE );
         }
 
         template <endpoint_name Side>
+        constexpr
         bool is_open( ) const
         {
             using S = endpoint_type<Side>;
-            return ( attrs_[S::id] == attributes::OPEN );
+            return ( ends_.attr( S::id ) == attributes::OPEN );
         }
 
+        constexpr
         bool has_infinite( ) const
         {
             return ( ( attrs<endpoint_name::LEFT>( )
@@ -806,6 +1078,7 @@ namespace intervals {
                  ;
         }
 
+        constexpr
         bool has_open( ) const
         {
             return is_open<endpoint_name::LEFT> ( )
@@ -814,6 +1087,7 @@ namespace intervals {
         }
 
         template <endpoint_name Side>
+        constexpr
         bool is_any_inf( ) const
         {
             return is_minus_inf<Side>( )
@@ -821,68 +1095,76 @@ namespace intervals {
         }
 
         template <endpoint_name Side>
+        constexpr
         bool is_minus_inf( ) const
         {
             using S = endpoint_type<Side>;
-            return ( attrs_[S::id] == attributes::MIN_INF );
+            return ( ends_.attr( S::id ) == attributes::MIN_INF );
         }
 
         template <endpoint_name Side>
+        constexpr
         bool is_plus_inf( ) const
         {
             using S = endpoint_type<Side>;
-            return ( attrs_[S::id] == attributes::MAX_INF );
+            return ( ends_.attr( S::id ) == attributes::MAX_INF );
         }
 
         template <endpoint_name Side>
-        const domain_type &value( ) const
+        constexpr
+        value_reference value( ) const
         {
             using S = endpoint_type<Side>;
             return value( typename S::pointer( ) ) ;
         }
 
-        const domain_type &value( left_type::pointer ) const
+        constexpr
+        value_reference value( left_type::pointer ) const
         {
-            return left_;
+            return ends_.left( );
         }
 
-        const domain_type &value( right_type::pointer ) const
+        constexpr
+        value_reference value( right_type::pointer ) const
         {
-            return right_;
+            return ends_.right( );
         }
 
         template <endpoint_name Side>
-        const attributes &attrs( ) const
+        constexpr
+        attributes attrs( ) const
         {
             using S = endpoint_type<Side>;
-            return attrs_[S::id];
+            return ends_.attr( S::id );
         }
 
     private:
 
+        using rvalue_type = typename endpoints_type::rvalue;
+
         template <endpoint_name Side>
-        domain_type &&mv_value( )
+        rvalue_type mv_value( )
         {
             using S = endpoint_type<Side>;
             return mv_value(typename S::pointer( ));
         }
 
-        domain_type &&mv_value( left_type::pointer )
+        rvalue_type mv_value( left_type::pointer )
         {
-            return std::move(left_);
+            return ends_.take_left( );
         }
 
-        domain_type &&mv_value( right_type::pointer )
+        rvalue_type mv_value( right_type::pointer )
         {
-            return std::move(right_);
+            return ends_.take_right( );
         }
 
-        domain_type &&mv_left( )
+        rvalue_type mv_left( )
         {
             return mv_value<endpoint_name::LEFT>( );
         }
 
-        domain_type &&mv_right( )
+        rvalue_type mv_right( )
         {
             return mv_value<endpoint_name::RIGHT>( );
         }
@@ -933,6 +1215,25 @@ namespace intervals {
 
         template <endpoint_name Side>
         bool connected( const interval &other ) const
+        {
+            return connected<Side>( other, method( ) );
+        }
+
+        /// the left end of the one is the right end of the other
+        /// and isn't an infinity
+        template <endpoint_name Side>
+        constexpr
+        bool connected( const interval &other, by_values ) const
+        {
+            return ( value<Side>( )
+                  == other.value<endpoint_type<Side>::opposite::name>( ) )
+                 & ( value<Side>( )
+                  != std::numeric_limits<domain_type>::lowest( ) )
+                 & ( value<Side>( ) != max_value( ) );
+        }
+
+        template <endpoint_name Side>
+        bool connected( const interval &other, by_attrs ) const
         {
             using Op = typename endpoint_type<Side>::opposite;
 
@@ -984,24 +1285,22 @@ namespace intervals {
 
     private:
 
-        domain_type left_ { };
-        domain_type right_{ };
-        attributes attrs_[2];
+        endpoints_type ends_;
     };
 
-    template <typename ValueT, typename Comparator>
+    template <typename ValueT, typename Comparator, typename LayoutT>
     inline
-    bool operator < ( const interval<ValueT, Comparator> &lh,
-                      const interval<ValueT, Comparator> &rh )
+    bool operator < ( const interval<ValueT, Comparator, LayoutT> &lh,
+                      const interval<ValueT, Comparator, LayoutT> &rh )
     {
-        using Ival = interval<ValueT, Comparator>;
+        using Ival = interval<ValueT, Comparator, LayoutT>;
         return Ival::cmp::less( lh, rh );
     }
 
-    template <typename ValueT, typename Comparator>
+    template <typename ValueT, typename Comparator, typename LayoutT>
     inline
     std::ostream &operator << ( std::ostream &o,
-                                const interval<ValueT, Comparator> &val )
+                            const interval<ValueT, Comparator, LayoutT> &val )
     {
         return val.out( o );
     }
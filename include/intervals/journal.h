@@ -0,0 +1,311 @@
+#ifndef ETOOL_INTERVALS_JOURNAL_H
+#define ETOOL_INTERVALS_JOURNAL_H
+
+#include <utility>
+#include <vector>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    namespace detail {
+
+        /// the elements of the maps have constant keys;
+        /// a delta keeps them in a form that can be assigned
+        template <typename ValueT>
+        struct storable {
+            using type = ValueT;
+        };
+
+        template <typename KeyT, typename ValueT>
+        struct storable<std::pair<const KeyT, ValueT> > {
+            using type = std::pair<KeyT, ValueT>;
+        };
+    }
+
+    /// One mutation of a set or a map.
+    /// Everything inside 'removed' was replaced with 'inserted'
+    template <typename TreeT>
+    struct delta {
+
+        using key_type      = typename TreeT::key_type;
+        using segment_type  = typename detail::storable<
+                                       typename TreeT::value_type>::type;
+
+        key_type                  removed;
+        std::vector<segment_type> inserted;
+    };
+
+    /// Replays a delta on a replica that had the same content
+    /// as the source had before the mutation
+    template <typename TreeT, typename SourceT>
+    inline
+    void apply_delta( TreeT &replica, const delta<SourceT> &change )
+    {
+        using value_type = typename TreeT::value_type;
+
+        auto hint = replica.cut( change.removed );
+        for( auto &seg: change.inserted ) {
+            hint = replica.insert( hint, value_type( seg ) );
+        }
+    }
+
+    /// The set or the map that records every mutation as a delta.
+    /// A delta covers the changed elements, their connected neighbours
+    /// and the elements they were fused with, so replication
+    /// costs O(change). Empty intervals like [a, a) are not replicated.
+    /// 'operator []' and the in-place 'merge_left/right' and
+    /// 'absorb_left/right' are not available because their changes
+    /// can't be seen
+    template <typename TreeT>
+    class journaled: public TreeT {
+
+        using parent_type = TreeT;
+
+    public:
+
+        using delta_type        = delta<TreeT>;
+        using key_type          = typename parent_type::key_type;
+        using value_type        = typename parent_type::value_type;
+        using iterator          = typename parent_type::iterator;
+        using const_iterator    = typename parent_type::const_iterator;
+        using iterator_access   = typename parent_type::iterator_access;
+
+        iterator insert( value_type val )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::insert( std::move(val) );
+            } );
+        }
+
+        iterator insert( const_iterator hint, value_type val )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::insert( hint, std::move(val) );
+            } );
+        }
+
+        template <typename IterT>
+        void insert( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                insert( value_type( *begin ) );
+            }
+        }
+
+        iterator merge( value_type val )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::merge( std::move(val) );
+            } );
+        }
+
+        iterator merge( const_iterator hint, value_type val )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::merge( hint, std::move(val) );
+            } );
+        }
+
+        template <typename IterT>
+        void merge( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                merge( value_type( *begin ) );
+            }
+        }
+
+        iterator absorb( value_type val )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::absorb( std::move(val) );
+            } );
+        }
+
+        iterator absorb( const_iterator hint, value_type val )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::absorb( hint, std::move(val) );
+            } );
+        }
+
+        template <typename IterT>
+        void absorb( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                absorb( value_type( *begin ) );
+            }
+        }
+
+        iterator cut( const key_type &key )
+        {
+            return record( key, [&]( ) {
+                return parent_type::cut( key );
+            } );
+        }
+
+        iterator cut( const_iterator hint, const key_type &key )
+        {
+            return record( key, [&]( ) {
+                return parent_type::cut( hint, key );
+            } );
+        }
+
+        template <typename IterT>
+        void cut( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                cut( *begin );
+            }
+        }
+
+        template <typename CombineT>
+        iterator aggregate( value_type val, CombineT combine )
+        {
+            key_type key = iterator_access::key( val );
+            return record( key, [&]( ) {
+                return parent_type::aggregate( std::move(val), combine );
+            } );
+        }
+
+        iterator erase( const_iterator itr )
+        {
+            key_type key = iterator_access::key( itr );
+            return record( key, [&]( ) {
+                return parent_type::erase( itr );
+            } );
+        }
+
+        iterator erase( const_iterator from, const_iterator to )
+        {
+            using I = iterator_access;
+            if( from == to ) {
+                return parent_type::erase( from, to );
+            }
+            key_type key = key_type::intersection( I::key(from),
+                                                   I::key(std::prev(to)) );
+            return record( key, [&]( ) {
+                return parent_type::erase( from, to );
+            } );
+        }
+
+        void compact( )
+        {
+            record( key_type::infinite( ), [this]( ) {
+                parent_type::compact( );
+                return 0;
+            } );
+        }
+
+        template <typename KeyArgT>
+        void operator [ ] ( const KeyArgT & ) = delete;
+
+        iterator merge_left( iterator )   = delete;
+        iterator merge_right( iterator )  = delete;
+        iterator absorb_left( iterator )  = delete;
+        iterator absorb_right( iterator ) = delete;
+
+        const std::vector<delta_type> &changes( ) const
+        {
+            return changes_;
+        }
+
+        /// gives the recorded deltas away
+        std::vector<delta_type> take_changes( )
+        {
+            std::vector<delta_type> res;
+            res.swap( changes_ );
+            return res;
+        }
+
+    private:
+
+        /// 'key' with the elements it touches
+        key_type hull( const key_type &key ) const
+        {
+            using I   = iterator_access;
+            using cmp = typename key_type::cmp;
+
+            auto range = parent_type::find_intersection( key );
+            if( range.first == range.second ) {
+                return key;
+            }
+
+            key_type lo = key;
+            key_type hi = key;
+            if( cmp::less_left( I::key(range.first), lo ) ) {
+                lo = I::key(range.first);
+            }
+            auto back = std::prev(range.second);
+            if( cmp::less_right( hi, I::key(back) ) ) {
+                hi = I::key(back);
+            }
+            return key_type::intersection( lo, hi );
+        }
+
+        /// the hull with the connected neighbours
+        key_type affected( const key_type &key ) const
+        {
+            using I = iterator_access;
+
+            key_type res = hull( key );
+            auto range = parent_type::find_intersection( res );
+
+            key_type lo = res;
+            key_type hi = res;
+            if( range.first != parent_type::begin( ) ) {
+                auto prev = std::prev(range.first);
+                if( res.left_connected( I::key(prev) ) ) {
+                    lo = I::key(prev);
+                }
+            }
+            if( range.second != parent_type::end( )
+             && res.right_connected( I::key(range.second) ) )
+            {
+                hi = I::key(range.second);
+            }
+            return key_type::intersection( lo, hi );
+        }
+
+        template <typename CallT>
+        auto record( const key_type &key, CallT call ) -> decltype(call( ))
+        {
+            using I = iterator_access;
+
+            delta_type change;
+            change.removed = affected( key );
+
+            auto res = call( );
+
+            /// the elements can grow out of the span, so the span grows
+            /// with them; everything outside it is untouched
+            change.removed = hull( change.removed );
+            auto view = parent_type::intersect_view( change.removed );
+            for( auto itr = view.begin( ); itr != view.end( ); ++itr ) {
+                value_type val;
+                I::copy( val, I::val( itr.base( ) ) );
+                I::mutable_key( val ) = (*itr).first;
+                change.inserted.emplace_back( std::move(val) );
+            }
+            changes_.emplace_back( std::move(change) );
+            return res;
+        }
+
+        std::vector<delta_type> changes_;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // JOURNAL_H
@@ -0,0 +1,365 @@
+#ifndef ETOOL_INTERVALS_LAYOUT_H
+#define ETOOL_INTERVALS_LAYOUT_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "intervals/attributes.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// How an interval keeps its endpoints
+    namespace layout {
+
+        /// two values and an 'attributes' field per side
+        struct wide { };
+
+        /// two values and both endpoint kinds in one byte, no padding:
+        /// interval<std::uint64_t> takes 17 bytes instead of 24.
+        /// The values are read by copy, so the domain must be
+        /// trivially copyable
+        struct packed { };
+
+        /// only two values: every interval is [a, b). The lowest and
+        /// the max values of the domain are -inf and +inf, the other
+        /// kinds of the ends are converted: '(a' is '[a+1', 'b]' is
+        /// 'b+1)'. The +inf end holds the max value, so '[a, max]'
+        /// and '[a, +inf)' contain it; '[a, max)' and '[a, max-1]'
+        /// can't be told from them. For the integral domains with
+        /// 'std::less'
+        struct half_open { };
+    }
+
+    /// The layout of 'interval<DomainT>' when it isn't given explicitly.
+    /// Specialize it to make every interval of the domain compact,
+    /// including the ones inside sets, maps and their traits.
+    /// Every translation unit must see the same specialization
+    template <typename DomainT>
+    struct default_layout {
+        using type = layout::wide;
+    };
+
+    /// Specialize it as 'std::true_type' for an integral domain to keep
+    /// every interval in the canonical form [a, b): '[1, 2]' becomes
+    /// '[1, 3)', '(0, 5)' becomes '[1, 5)'. Then '[1, 2]' and '[3, 4]'
+    /// are connected and 'absorb' fuses them.
+    /// A closed right end at the max value becomes +inf.
+    /// Like 'default_layout' it must be the same in every translation
+    /// unit; a specialization for a comparator of its own (that keeps
+    /// the natural order) leaves the other intervals of the domain as is
+    template <typename DomainT, typename Comparator = std::less<DomainT> >
+    struct discrete_domain: std::false_type { };
+
+    namespace detail {
+
+        /// 'std::move' for the constant expressions of C++11
+        template <typename T>
+        constexpr
+        typename std::remove_reference<T>::type &&move( T &&val ) noexcept
+        {
+            return static_cast<typename std::remove_reference<T>::type &&>(
+                                                                        val );
+        }
+
+        template <typename DomainT, typename LayoutT>
+        class endpoints;
+
+        template <typename DomainT>
+        class endpoints<DomainT, layout::wide> {
+
+        public:
+
+            using reference = const DomainT &;
+            using rvalue    = DomainT &&;
+
+            endpoints( ) = default;
+
+            constexpr
+            endpoints( DomainT lh, DomainT rh,
+                       attributes lf, attributes rf )
+                :left_(detail::move(lh))
+                ,right_(detail::move(rh))
+                ,attrs_{ lf, rf }
+            { }
+
+            constexpr
+            reference left( ) const noexcept
+            {
+                return left_;
+            }
+
+            constexpr
+            reference right( ) const noexcept
+            {
+                return right_;
+            }
+
+            rvalue take_left( ) noexcept
+            {
+                return std::move(left_);
+            }
+
+            rvalue take_right( ) noexcept
+            {
+                return std::move(right_);
+            }
+
+            constexpr
+            attributes attr( int id ) const noexcept
+            {
+                return attrs_[id];
+            }
+
+            void set_attr( int id, attributes val ) noexcept
+            {
+                attrs_[id] = val;
+            }
+
+            void replace_left( const endpoints &other )
+            {
+                attrs_[0] = other.attrs_[0];
+                left_     = other.left_;
+            }
+
+            void replace_right( const endpoints &other )
+            {
+                attrs_[1] = other.attrs_[1];
+                right_    = other.right_;
+            }
+
+            void swap( endpoints &other )
+            {
+                std::swap( attrs_[0], other.attrs_[0] );
+                std::swap( attrs_[1], other.attrs_[1] );
+                std::swap( left_,     other.left_ );
+                std::swap( right_,    other.right_ );
+            }
+
+        private:
+
+            DomainT    left_ { };
+            DomainT    right_{ };
+            attributes attrs_[2];
+        };
+
+#pragma pack(push, 1)
+
+        template <typename DomainT>
+        class endpoints<DomainT, layout::packed> {
+
+            static_assert( std::is_trivially_copyable<DomainT>::value,
+                           "Packed layout. The domain must be "
+                           "trivially copyable." );
+
+            using u8 = std::uint8_t;
+
+        public:
+
+            /// a packed field can't be referenced
+            using reference = DomainT;
+            using rvalue    = DomainT;
+
+            endpoints( ) = default;
+
+            constexpr
+            endpoints( DomainT lh, DomainT rh,
+                       attributes lf, attributes rf )
+                :left_(lh)
+                ,right_(rh)
+                ,kinds_(static_cast<u8>( static_cast<u8>(lf)
+                                       | ( static_cast<u8>(rf) << 4 ) ))
+            { }
+
+            constexpr
+            reference left( ) const noexcept
+            {
+                return left_;
+            }
+
+            constexpr
+            reference right( ) const noexcept
+            {
+                return right_;
+            }
+
+            rvalue take_left( ) noexcept
+            {
+                return left_;
+            }
+
+            rvalue take_right( ) noexcept
+            {
+                return right_;
+            }
+
+            /// every kind is a single bit of the low 4
+            constexpr
+            attributes attr( int id ) const noexcept
+            {
+                return static_cast<attributes>( ( kinds_ >> ( id * 4 ) )
+                                              & 0x0F );
+            }
+
+            void set_attr( int id, attributes val ) noexcept
+            {
+                const int shift = id * 4;
+                kinds_ = static_cast<u8>( ( kinds_ & ~( 0x0F << shift ) )
+                                        | ( static_cast<u8>(val) << shift ) );
+            }
+
+            void replace_left( const endpoints &other )
+            {
+                set_attr( 0, other.attr( 0 ) );
+                left_ = other.left_;
+            }
+
+            void replace_right( const endpoints &other )
+            {
+                set_attr( 1, other.attr( 1 ) );
+                right_ = other.right_;
+            }
+
+            void swap( endpoints &other )
+            {
+                endpoints tmp( *this );
+                *this = other;
+                other = tmp;
+            }
+
+        private:
+
+            DomainT left_ { };
+            DomainT right_{ };
+            u8      kinds_ = 0;
+        };
+
+#pragma pack(pop)
+
+        template <typename DomainT>
+        class endpoints<DomainT, layout::half_open> {
+
+            static_assert( std::is_integral<DomainT>::value,
+                           "Half-open layout. The domain must be "
+                           "integral." );
+
+            using limits = std::numeric_limits<DomainT>;
+
+        public:
+
+            using reference = const DomainT &;
+            using rvalue    = DomainT;
+
+            endpoints( ) = default;
+
+            constexpr
+            endpoints( DomainT lh, DomainT rh,
+                       attributes lf, attributes rf )
+                :left_(start( lh, lf ))
+                ,right_(end( rh, rf ))
+            { }
+
+            constexpr
+            reference left( ) const noexcept
+            {
+                return left_;
+            }
+
+            constexpr
+            reference right( ) const noexcept
+            {
+                return right_;
+            }
+
+            rvalue take_left( ) noexcept
+            {
+                return left_;
+            }
+
+            rvalue take_right( ) noexcept
+            {
+                return right_;
+            }
+
+            constexpr
+            attributes attr( int id ) const noexcept
+            {
+                return kind( id ? right_ : left_, id );
+            }
+
+            void replace_left( const endpoints &other )
+            {
+                left_ = other.left_;
+            }
+
+            void replace_right( const endpoints &other )
+            {
+                right_ = other.right_;
+            }
+
+            void swap( endpoints &other )
+            {
+                std::swap( left_,  other.left_ );
+                std::swap( right_, other.right_ );
+            }
+
+        private:
+
+            static constexpr
+            attributes kind( DomainT val, int id )
+            {
+                return ( val == limits::lowest( ) ) ? attributes::MIN_INF
+                     : ( val == limits::max( ) )    ? attributes::MAX_INF
+                     : id                           ? attributes::OPEN
+                     :                                attributes::CLOSE;
+            }
+
+            static constexpr
+            DomainT next( DomainT val )
+            {
+                return ( val == limits::max( ) )
+                     ? val
+                     : static_cast<DomainT>( val + 1 );
+            }
+
+            /// the value that keeps the kind of the end
+            static constexpr
+            DomainT place( DomainT val, attributes attr, attributes moved )
+            {
+                return ( attr == attributes::MIN_INF ) ? limits::lowest( )
+                     : ( attr == attributes::MAX_INF ) ? limits::max( )
+                     : ( attr == moved )               ? next( val )
+                     :                                   val;
+            }
+
+            static constexpr
+            DomainT start( DomainT val, attributes attr )
+            {
+                return place( val, attr, attributes::OPEN );
+            }
+
+            static constexpr
+            DomainT end( DomainT val, attributes attr )
+            {
+                return place( val, attr, attributes::CLOSE );
+            }
+
+            DomainT left_ { };
+            DomainT right_{ };
+        };
+
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // LAYOUT_H
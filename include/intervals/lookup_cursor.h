@@ -0,0 +1,87 @@
+#ifndef ETOOL_INTERVALS_LOOKUP_CURSOR_H
+#define ETOOL_INTERVALS_LOOKUP_CURSOR_H
+
+#include "intervals/search.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Looks up a sorted stream of values in a set or a map.
+    /// Every 'seek' continues from the position of the previous one,
+    /// so a dense stream costs amortized O(1) per value.
+    /// 'seek' returns the same iterator as 'find' does.
+    /// Values that go backwards are allowed but they are not cheap.
+    /// Any modification of the container invalidates the cursor.
+    template <typename TreeT>
+    class lookup_cursor {
+
+    public:
+
+        using tree_type         = TreeT;
+        using key_type          = typename tree_type::key_type;
+        using domain_type       = typename tree_type::domain_type;
+        using const_iterator    = typename tree_type::const_iterator;
+        using iterator_access   = typename tree_type::iterator_access;
+
+        explicit lookup_cursor( const tree_type &tree )
+            :tree_(&tree)
+            ,pos_(tree.begin( ))
+        { }
+
+        const_iterator seek( const domain_type &val )
+        {
+            using I   = iterator_access;
+            using cmp = typename key_type::cmp_not_overlap;
+
+            const key_type key( val );
+
+            auto before = [&key]( const_iterator itr ) {
+                return cmp::less( I::key(itr), key );
+            };
+
+            const_iterator res = pos_;
+            if( !search::partition_point_near( tree_->begin( ), pos_,
+                                               tree_->end( ), before, res ) )
+            {
+                res = tree_->find_intersection( key ).first;
+            }
+            pos_ = res;
+
+            return ( pos_ != tree_->end( ) && I::key(pos_).contains( val ) )
+                 ? pos_
+                 : tree_->end( );
+        }
+
+        /// the first element that is not entirely before the last value
+        const_iterator position( ) const
+        {
+            return pos_;
+        }
+
+        void reset( )
+        {
+            pos_ = tree_->begin( );
+        }
+
+    private:
+        const tree_type *tree_;
+        const_iterator   pos_;
+    };
+
+    template <typename TreeT>
+    inline
+    lookup_cursor<TreeT> make_lookup_cursor( const TreeT &tree )
+    {
+        return lookup_cursor<TreeT>( tree );
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // LOOKUP_CURSOR_H
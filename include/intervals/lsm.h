@@ -0,0 +1,428 @@
+#ifndef ETOOL_INTERVALS_LSM_H
+#define ETOOL_INTERVALS_LSM_H
+
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "intervals/set.h"
+#include "intervals/map.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Two-tier set or map for bursty writes and fast reads.
+    /// Writes go to a small mutable memtable ('TreeT'); a background
+    /// thread compacts it into an immutable flat base ('BaseT').
+    /// The memtable keeps the spans it owns (its coverage): inside them
+    /// it has the whole content, a 'cut' leaves an empty span
+    /// (a tombstone). Reads check the memtable, then the table that
+    /// is being compacted, then the base.
+    /// Before a write the memtable takes over the elements the write
+    /// touches, so insert/merge/absorb/cut work as on a single tree.
+    /// The readers don't take the writers' lock: a short second lock
+    /// guards the memtable and the tier pointers. A reader holds it
+    /// for one lookup in the memtable, a writer for the change
+    /// of the memtable in place; the compaction runs without it.
+    /// Empty intervals like [a, a) are ignored.
+    template <typename TreeT, typename BaseT>
+    class lsm {
+
+    public:
+
+        using tree_type         = TreeT;
+        using base_type         = BaseT;
+        using key_type          = typename tree_type::key_type;
+        using value_type        = typename tree_type::value_type;
+        using domain_type       = typename key_type::domain_type;
+        using segment_type      = typename detail::storable<value_type>::type;
+
+    private:
+
+        using comparator_type   = typename key_type::comparator_type;
+        using cover_type        = set<domain_type, comparator_type>;
+
+        struct layer {
+            tree_type  tree;
+            cover_type cover;
+
+            /// what the compaction is started by
+            std::size_t weight( ) const
+            {
+                return tree.size( ) + cover.size( );
+            }
+
+            bool covered( const domain_type &val ) const
+            {
+                return cover.find( val ) != cover.end( );
+            }
+
+            bool covered( const key_type &key ) const
+            {
+                auto range = cover.find_intersection( key );
+                return range.first != range.second;
+            }
+        };
+
+        using layer_ptr = std::shared_ptr<const layer>;
+        using base_ptr  = std::shared_ptr<const base_type>;
+
+    public:
+
+        /// 'threshold' is the memtable size that starts a compaction
+        explicit lsm( std::size_t threshold = 4096 )
+            :threshold_(threshold)
+            ,mem_(std::make_shared<layer>( ))
+            ,base_(std::make_shared<const base_type>( ))
+            ,worker_([this]( ) { compactor( ); })
+        { }
+
+        lsm( const lsm & ) = delete;
+        lsm &operator = ( const lsm & ) = delete;
+
+        ~lsm( )
+        {
+            {
+                std::lock_guard<std::mutex> lck(lock_);
+                stop_ = true;
+            }
+            wake_.notify_one( );
+            worker_.join( );
+        }
+
+        void insert( value_type val )
+        {
+            key_type key = tree_type::iterator_access::key( val );
+            write( key, false, [&val]( tree_type &t ) {
+                t.insert( std::move(val) );
+            } );
+        }
+
+        void merge( value_type val )
+        {
+            key_type key = tree_type::iterator_access::key( val );
+            write( key, false, [&val]( tree_type &t ) {
+                t.merge( std::move(val) );
+            } );
+        }
+
+        void absorb( value_type val )
+        {
+            key_type key = tree_type::iterator_access::key( val );
+            write( key, true, [&val]( tree_type &t ) {
+                t.absorb( std::move(val) );
+            } );
+        }
+
+        void cut( const key_type &key )
+        {
+            write( key, false, [&key]( tree_type &t ) {
+                t.cut( key );
+            } );
+        }
+
+        /// the element that contains 'val'; 'second' is false if none.
+        /// Only the memtable lookup is done under the short lock
+        std::pair<segment_type, bool> find( const domain_type &val ) const
+        {
+            layer_ptr frozen;
+            base_ptr  base;
+            {
+                std::lock_guard<std::mutex> lck(view_lock_);
+                if( mem_->covered( val ) ) {
+                    return find_in( mem_->tree, val );
+                }
+                frozen = frozen_;
+                base   = base_;
+            }
+            if( frozen && frozen->covered( val ) ) {
+                return find_in( frozen->tree, val );
+            }
+            return find_in( *base, val );
+        }
+
+        bool contains( const domain_type &val ) const
+        {
+            return find( val ).second;
+        }
+
+        /// the whole content as a single tree
+        tree_type snapshot( ) const
+        {
+            layer     mem;
+            layer_ptr frozen;
+            base_ptr  base;
+            {
+                std::lock_guard<std::mutex> lck(view_lock_);
+                mem    = *mem_;
+                frozen = frozen_;
+                base   = base_;
+            }
+
+            tree_type res;
+            auto hint = res.end( );
+            for( auto &val: *base ) {
+                hint = res.insert( hint, value_type( val ) );
+            }
+            if( frozen ) {
+                overlay( res, *frozen );
+            }
+            overlay( res, mem );
+            return res;
+        }
+
+        /// blocks until everything written before is in the base
+        void flush( )
+        {
+            std::unique_lock<std::mutex> lck(lock_);
+            while( frozen_ || !mem_->cover.empty( ) ) {
+                std::size_t gen = generation_;
+                flush_ = true;
+                wake_.notify_one( );
+                done_.wait( lck, [this, gen]( ) {
+                    return generation_ != gen;
+                } );
+            }
+        }
+
+        /// the number of the finished compactions
+        std::size_t generation( ) const
+        {
+            std::lock_guard<std::mutex> lck(lock_);
+            return generation_;
+        }
+
+    private:
+
+        template <typename SrcT>
+        static
+        std::pair<segment_type, bool> find_in( const SrcT &src,
+                                               const domain_type &val )
+        {
+            auto itr = src.find( val );
+            if( itr == src.end( ) ) {
+                return std::make_pair( segment_type( ), false );
+            }
+            return std::make_pair( segment_type( *itr ), true );
+        }
+
+        /// the elements of 'src' that intersect 'key' or are connected to it
+        template <typename SrcT>
+        static
+        std::pair<typename SrcT::const_iterator,
+                  typename SrcT::const_iterator>
+        touching( const SrcT &src, const key_type &key )
+        {
+            using I = typename SrcT::iterator_access;
+
+            auto range = src.find_intersection( key );
+            if( range.first != src.begin( )
+             && key.left_connected( I::key(std::prev(range.first)) ) )
+            {
+                --range.first;
+            }
+            if( range.second != src.end( )
+             && key.right_connected( I::key(range.second) ) )
+            {
+                ++range.second;
+            }
+            return range;
+        }
+
+        /// 'key' with the elements of 'tree' it touches
+        static key_type hull( const tree_type &tree, const key_type &key )
+        {
+            using I   = typename tree_type::iterator_access;
+            using cmp = typename key_type::cmp;
+
+            auto range = touching( tree, key );
+            if( range.first == range.second ) {
+                return key;
+            }
+
+            key_type lo = key;
+            key_type hi = key;
+            if( cmp::less_left( I::key(range.first), lo ) ) {
+                lo = I::key(range.first);
+            }
+            auto back = std::prev(range.second);
+            if( cmp::less_right( hi, I::key(back) ) ) {
+                hi = I::key(back);
+            }
+            return key_type::intersection( lo, hi );
+        }
+
+        /// copies the touched elements of 'src' that nobody above covers
+        template <typename SrcT>
+        static void take_over( layer &mem, const SrcT &src,
+                               const key_type &key, const layer *above )
+        {
+            using I = typename SrcT::iterator_access;
+
+            auto range = touching( src, key );
+            for( auto itr = range.first; itr != range.second; ++itr ) {
+                const key_type &elem = I::key(itr);
+                if( mem.covered( elem )
+                 || ( above && above->covered( elem ) ) )
+                {
+                    continue;
+                }
+                mem.tree.insert( value_type( *itr ) );
+            }
+        }
+
+        template <typename CallT>
+        void write( const key_type &key, bool chain, CallT call )
+        {
+            if( key.empty( ) ) {
+                return;
+            }
+
+            using cmp = typename key_type::cmp;
+
+            std::unique_lock<std::mutex> lck(lock_);
+            std::unique_lock<std::mutex> view_lck(view_lock_);
+            layer &mem = *mem_;
+            key_type span = key;
+            while( true ) {
+                if( frozen_ ) {
+                    take_over( mem, frozen_->tree, span, nullptr );
+                }
+                take_over( mem, *base_, span, frozen_.get( ) );
+                key_type next = hull( mem.tree, span );
+                bool grown = cmp::less_left( next, span )
+                          || cmp::less_right( span, next );
+                span = next;
+                /// 'absorb' fuses the whole chain of connected elements
+                if( !chain || !grown ) {
+                    break;
+                }
+            }
+            call( mem.tree );
+            /// the elements can grow out of the span
+            span = hull( mem.tree, span );
+            mem.cover.absorb( span );
+            view_lck.unlock( );
+
+            if( mem.weight( ) >= threshold_ ) {
+                lck.unlock( );
+                wake_.notify_one( );
+            }
+        }
+
+        /// replaces the covered spans of 'to' with the content of 'top'
+        static void overlay( tree_type &to, const layer &top )
+        {
+            for( auto &span: top.cover ) {
+                to.cut( span );
+            }
+            auto hint = to.begin( );
+            for( auto &val: top.tree ) {
+                hint = to.insert( hint, val );
+            }
+        }
+
+        /// one linear pass: the base elements outside the coverage
+        /// and the elements of the table in the key order
+        static
+        std::shared_ptr<const base_type> build( const base_type &base,
+                                                const layer &top )
+        {
+            using BI  = typename base_type::iterator_access;
+            using TI  = typename tree_type::iterator_access;
+            using cmp = typename key_type::cmp;
+            using base_value = typename base_type::value_type;
+
+            std::shared_ptr<base_type> res = std::make_shared<base_type>( );
+
+            auto titr = top.tree.begin( );
+            for( auto bitr = base.begin( ); bitr != base.end( ); ++bitr ) {
+                if( top.covered( BI::key(bitr) ) ) {
+                    continue;
+                }
+                while( titr != top.tree.end( )
+                    && cmp::less_left( TI::key(titr), BI::key(bitr) ) )
+                {
+                    res->insert( res->end( ), base_value( *titr++ ) );
+                }
+                res->insert( res->end( ), *bitr );
+            }
+            for( ; titr != top.tree.end( ); ++titr ) {
+                res->insert( res->end( ), base_value( *titr ) );
+            }
+            return res;
+        }
+
+        void compactor( )
+        {
+            std::unique_lock<std::mutex> lck(lock_);
+            while( true ) {
+                wake_.wait( lck, [this]( ) {
+                    return stop_ || flush_
+                        || mem_->weight( ) >= threshold_;
+                } );
+                if( stop_ ) {
+                    break;
+                }
+                flush_ = false;
+
+                {
+                    std::lock_guard<std::mutex> view_lck(view_lock_);
+                    frozen_ = std::move(mem_);
+                    mem_    = std::make_shared<layer>( );
+                }
+
+                auto base   = base_;
+                auto frozen = frozen_;
+                lck.unlock( );
+
+                auto next = build( *base, *frozen );
+
+                lck.lock( );
+                {
+                    std::lock_guard<std::mutex> view_lck(view_lock_);
+                    base_ = std::move(next);
+                    frozen_.reset( );
+                }
+                ++generation_;
+                done_.notify_all( );
+            }
+        }
+
+        const std::size_t                threshold_;
+        /// changed under both locks, read under any of them
+        std::shared_ptr<layer>           mem_;
+        layer_ptr                        frozen_;
+        base_ptr                         base_;
+        std::size_t                      generation_ = 0;
+        bool                             flush_ = false;
+        bool                             stop_  = false;
+        /// the writers and the compactor
+        mutable std::mutex               lock_;
+        /// the readers and a change of the memtable or of the pointers
+        mutable std::mutex               view_lock_;
+        std::condition_variable          wake_;
+        std::condition_variable          done_;
+        /// the last one: it starts when everything else is ready
+        std::thread                      worker_;
+    };
+
+    template <typename KeyT, typename Comp = std::less<KeyT> >
+    using lsm_set = lsm<set<KeyT, Comp>, flat_set<KeyT, Comp> >;
+
+    template <typename KeyT, typename ValueT, typename Comp = std::less<KeyT> >
+    using lsm_map = lsm<map<KeyT, ValueT, Comp>, flat_map<KeyT, ValueT, Comp> >;
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // LSM_H
@@ -4,6 +4,9 @@
 #include "intervals/tree.h"
 #include "intervals/traits/std_map.h"
 #include "intervals/traits/array_map.h"
+#include "intervals/traits/lazy_map.h"
+#include "intervals/traits/ranked_map.h"
+#include "intervals/shared_value.h"
 
 #ifdef INTERVALS_TOP_NANESPACE
 namespace INTERVALS_TOP_NANESPACE {
@@ -12,10 +15,11 @@ namespace INTERVALS_TOP_NANESPACE {
 namespace intervals {
 
     template <typename KeyT, typename ValueT, typename Comp = std::less<KeyT>,
-              typename AllocT = std::allocator<std::pair<const KeyT, ValueT> > >
-    class map: public tree<traits::std_map<KeyT, ValueT, Comp, AllocT> > {
+              typename AllocT = std::allocator<std::pair<const KeyT, ValueT> >,
+              typename TraitT = traits::std_map<KeyT, ValueT, Comp, AllocT> >
+    class map: public tree<TraitT> {
 
-        using parent_type = tree< traits::std_map<KeyT, ValueT,Comp, AllocT> >;
+        using parent_type = tree<TraitT>;
 
     public:
 
@@ -32,6 +36,13 @@ namespace intervals {
             return parent_type::insert_impl(std::move(val));
         }
 
+        /// hinted versions. the search starts from 'hint' and the result
+        /// is a good hint for the next neighbouring value
+        iterator insert( const_iterator hint, value_type val )
+        {
+            return parent_type::insert_impl( hint, std::move(val) );
+        }
+
         template <typename IterT>
         void insert( IterT begin, IterT end )
         {
@@ -53,6 +64,11 @@ namespace intervals {
             return parent_type::merge_impl( std::move(val) );
         }
 
+        iterator merge( const_iterator hint, value_type val )
+        {
+            return parent_type::merge_impl( hint, std::move(val) );
+        }
+
         template <typename IterT>
         void absorb( IterT begin, IterT end )
         {
@@ -66,6 +82,11 @@ namespace intervals {
             return parent_type::absorb_impl( std::move(val) );
         }
 
+        iterator absorb( const_iterator hint, value_type val )
+        {
+            return parent_type::absorb_impl( hint, std::move(val) );
+        }
+
         template <typename IterT>
         void cut( IterT begin, IterT end )
         {
@@ -79,6 +100,43 @@ namespace intervals {
             return parent_type::cut_impl( val );
         }
 
+        iterator cut( const_iterator hint, const key_type &val )
+        {
+            return parent_type::cut_impl( hint, val );
+        }
+
+        /// Combines the values of the overlapped part of the map
+        /// with 'val.second': 'value = combine(value, val.second)'.
+        /// The elements are split at the endpoints of 'val.first';
+        /// the uncovered parts of 'val.first' get 'val.second'.
+        template <typename CombineT>
+        iterator aggregate( value_type val, CombineT combine )
+        {
+            return parent_type::aggregate_impl( std::move(val),
+                                                combiner<CombineT>(combine) );
+        }
+
+        template <typename CombineT>
+        iterator aggregate( const_iterator hint, value_type val,
+                            CombineT combine )
+        {
+            return parent_type::aggregate_impl( hint, std::move(val),
+                                                combiner<CombineT>(combine) );
+        }
+
+        /// fuses all the connected elements that have equal values.
+        /// one linear pass
+        void compact( )
+        {
+            compact( std::equal_to<mapped_type>( ) );
+        }
+
+        template <typename EqualT>
+        void compact( EqualT equal )
+        {
+            parent_type::compact_impl( mapped_equal<EqualT>(equal) );
+        }
+
         mapped_type &operator [ ] ( const key_type &k )
         {
             using C = typename key_type::cmp;
@@ -97,7 +155,451 @@ namespace intervals {
         {
             return operator [ ]( key_type( k ) );
         }
+
+    protected:
+
+        template <typename EqualT>
+        struct mapped_equal {
+
+            mapped_equal( EqualT &e )
+                :equal(e)
+            { }
+
+            bool operator ( )( const value_type &lh,
+                               const value_type &rh ) const
+            {
+                return equal( lh.second, rh.second );
+            }
+
+            EqualT &equal;
+        };
+
+    private:
+
+        template <typename CombineT>
+        struct combiner {
+
+            combiner( CombineT &c )
+                :combine(c)
+            { }
+
+            void operator ( )( value_type &to, const value_type &from )
+            {
+                to.second = combine( to.second, from.second );
+            }
+
+            CombineT &combine;
+        };
+    };
+
+    /// The map that combines the values instead of replacing them.
+    /// 'insert' works as 'aggregate' with 'CombineT'.
+    /// 'merge', 'absorb' and 'operator []' are not available here
+    /// because they replace the values
+    template <typename KeyT, typename ValueT,
+              typename CombineT = std::plus<ValueT>,
+              typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<std::pair<const KeyT, ValueT> >,
+              typename TraitT = traits::std_map<KeyT, ValueT, Comp, AllocT> >
+    class aggregating_map: public map<KeyT, ValueT, Comp, AllocT, TraitT> {
+
+        using parent_type = map<KeyT, ValueT, Comp, AllocT, TraitT>;
+
+    public:
+
+        using combine_type      = CombineT;
+        using value_type        = typename parent_type::value_type;
+        using iterator          = typename parent_type::iterator;
+        using const_iterator    = typename parent_type::const_iterator;
+
+        aggregating_map( ) = default;
+
+        explicit aggregating_map( combine_type combine )
+            :combine_(std::move(combine))
+        { }
+
+        iterator insert( value_type val )
+        {
+            return parent_type::aggregate( std::move(val), combine_ );
+        }
+
+        iterator insert( const_iterator hint, value_type val )
+        {
+            return parent_type::aggregate( hint, std::move(val), combine_ );
+        }
+
+        template <typename IterT>
+        void insert( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                insert( *begin );
+            }
+        }
+
+        template <typename ...Args>
+        iterator merge( Args&&... ) = delete;
+
+        template <typename ...Args>
+        iterator absorb( Args&&... ) = delete;
+
+        template <typename KeyArgT>
+        ValueT &operator [ ] ( const KeyArgT & ) = delete;
+
+    private:
+        combine_type combine_;
+    };
+
+    /// The map that never keeps connected elements with equal values.
+    /// Every mutation fuses the elements it touches; 'compact' does
+    /// the same for the whole map. The empty keys hold no values,
+    /// so they are ignored and 'end( )' is returned.
+    /// 'operator []' is not available here
+    /// because a value changed in place can't be fused
+    template <typename KeyT, typename ValueT,
+              typename EqualT = std::equal_to<ValueT>,
+              typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<std::pair<const KeyT, ValueT> >,
+              typename TraitT = traits::std_map<KeyT, ValueT, Comp, AllocT> >
+    class coalescing_map: public map<KeyT, ValueT, Comp, AllocT, TraitT> {
+
+        using parent_type = map<KeyT, ValueT, Comp, AllocT, TraitT>;
+
+    public:
+
+        using equal_type        = EqualT;
+        using key_type          = typename parent_type::key_type;
+        using value_type        = typename parent_type::value_type;
+        using iterator          = typename parent_type::iterator;
+        using const_iterator    = typename parent_type::const_iterator;
+
+        coalescing_map( ) = default;
+
+        explicit coalescing_map( equal_type equal )
+            :equal_(std::move(equal))
+        { }
+
+        iterator insert( value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::insert( std::move(val) ), key );
+        }
+
+        iterator insert( const_iterator hint, value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::insert( hint, std::move(val) ),
+                             key );
+        }
+
+        template <typename IterT>
+        void insert( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                insert( *begin );
+            }
+        }
+
+        iterator merge( value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::merge( std::move(val) ), key );
+        }
+
+        iterator merge( const_iterator hint, value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::merge( hint, std::move(val) ),
+                             key );
+        }
+
+        template <typename IterT>
+        void merge( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                merge( *begin );
+            }
+        }
+
+        iterator absorb( value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::absorb( std::move(val) ), key );
+        }
+
+        iterator absorb( const_iterator hint, value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::absorb( hint, std::move(val) ),
+                             key );
+        }
+
+        template <typename IterT>
+        void absorb( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                absorb( *begin );
+            }
+        }
+
+        iterator cut( const key_type &key )
+        {
+            if( key.empty( ) ) {
+                return parent_type::end( );
+            }
+            return coalesce( parent_type::cut( key ), key );
+        }
+
+        iterator cut( const_iterator hint, const key_type &key )
+        {
+            if( key.empty( ) ) {
+                return parent_type::end( );
+            }
+            return coalesce( parent_type::cut( hint, key ), key );
+        }
+
+        template <typename IterT>
+        void cut( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                cut( *begin );
+            }
+        }
+
+        template <typename CombineT>
+        iterator aggregate( value_type val, CombineT combine )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::aggregate( std::move(val),
+                                                     combine ), key );
+        }
+
+        template <typename CombineT>
+        iterator aggregate( const_iterator hint, value_type val,
+                            CombineT combine )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            key_type key = val.first;
+            return coalesce( parent_type::aggregate( hint, std::move(val),
+                                                     combine ), key );
+        }
+
+        void compact( )
+        {
+            parent_type::compact( equal_ );
+        }
+
+        template <typename KeyArgT>
+        ValueT &operator [ ] ( const KeyArgT & ) = delete;
+
+    private:
+
+        iterator coalesce( iterator itr, const key_type &key )
+        {
+            using equal = typename parent_type::template
+                                   mapped_equal<equal_type>;
+            return parent_type::coalesce_impl( itr, key, equal(equal_) );
+        }
+
+        equal_type equal_;
     };
+
+    /// The map with lazy range updates.
+    /// 'range_apply(key, tag)' does 'OpT::apply(value, tag)' for all
+    /// the values that overlap 'key' in O(log n): the elements are split
+    /// at the endpoints of 'key' and the tag is put on the root
+    /// of the subtree that holds them. A value is updated when its element
+    /// is reached by a search or by an iteration.
+    /// The uncovered parts of 'key' stay uncovered.
+    /// An empty element would hide its neighbours from the split,
+    /// so the empty keys are ignored and 'end( )' is returned.
+    /// The const members push the tags as well, so they are not safe
+    /// for concurrent readers until 'flush' applies all of them.
+    /// 'operator []' is not available here because it would skip
+    /// the checks of 'insert'; use 'find' and 'insert' instead
+    template <typename KeyT, typename ValueT,
+              typename OpT = lazy::add<ValueT>,
+              typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<std::pair<const KeyT, ValueT> > >
+    class lazy_map: public map<KeyT, ValueT, Comp, AllocT,
+                      traits::lazy_map<KeyT, ValueT, OpT, Comp, AllocT> > {
+
+        using trait_type  = traits::lazy_map<KeyT, ValueT, OpT, Comp, AllocT>;
+        using parent_type = map<KeyT, ValueT, Comp, AllocT, trait_type>;
+
+    public:
+
+        using op_type           = OpT;
+        using tag_type          = typename op_type::tag_type;
+        using key_type          = typename parent_type::key_type;
+        using value_type        = typename parent_type::value_type;
+        using iterator          = typename parent_type::iterator;
+        using const_iterator    = typename parent_type::const_iterator;
+
+        iterator insert( value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::insert( std::move(val) );
+        }
+
+        iterator insert( const_iterator hint, value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::insert( hint, std::move(val) );
+        }
+
+        template <typename IterT>
+        void insert( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                insert( *begin );
+            }
+        }
+
+        iterator merge( value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::merge( std::move(val) );
+        }
+
+        iterator merge( const_iterator hint, value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::merge( hint, std::move(val) );
+        }
+
+        template <typename IterT>
+        void merge( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                merge( *begin );
+            }
+        }
+
+        iterator absorb( value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::absorb( std::move(val) );
+        }
+
+        iterator absorb( const_iterator hint, value_type val )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::absorb( hint, std::move(val) );
+        }
+
+        template <typename IterT>
+        void absorb( IterT begin, IterT end )
+        {
+            for( ; begin != end; ++begin ) {
+                absorb( *begin );
+            }
+        }
+
+        template <typename CombineT>
+        iterator aggregate( value_type val, CombineT combine )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::aggregate( std::move(val), combine );
+        }
+
+        template <typename CombineT>
+        iterator aggregate( const_iterator hint, value_type val,
+                            CombineT combine )
+        {
+            if( val.first.empty( ) ) {
+                return parent_type::end( );
+            }
+            return parent_type::aggregate( hint, std::move(val), combine );
+        }
+
+        void range_apply( const key_type &key, const tag_type &tag )
+        {
+            using policy = typename trait_type::policy_type;
+            using node   = typename trait_type::container_type::node;
+
+            if( key.empty( ) ) {
+                return;
+            }
+            parent_type::split_impl( key );
+            parent_type::container( ).update_range( key,
+                [&tag]( node *n ) {
+                    policy::apply_tag( n, tag );
+                } );
+        }
+
+        /// applies all the pending tags; O(n)
+        void flush( )
+        {
+            parent_type::container( ).flush( );
+        }
+
+        template <typename KeyArgT>
+        ValueT &operator [ ] ( const KeyArgT & ) = delete;
+    };
+
+    /// the same map but stored in a sorted array
+    template <typename KeyT, typename ValueT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<
+                                  std::pair<interval<KeyT, Comp>, ValueT> > >
+    using flat_map = map<KeyT, ValueT, Comp, AllocT,
+                         traits::array_map<KeyT, ValueT, Comp, AllocT> >;
+
+    /// the same map in a treap; 'partition' is O(count * log(n))
+    template <typename KeyT, typename ValueT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<
+                          std::pair<const interval<KeyT, Comp>, ValueT> > >
+    using ranked_map = map<KeyT, ValueT, Comp, AllocT,
+                           traits::ranked_map<KeyT, ValueT, Comp, AllocT> >;
+
+    /// the maps that share the values between the pieces of a split;
+    /// 'itr->second.mutate( )' gives a value of this element only
+    template <typename KeyT, typename ValueT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<
+                          std::pair<const KeyT, shared_value<ValueT> > > >
+    using shared_map = map<KeyT, shared_value<ValueT>, Comp, AllocT>;
+
+    template <typename KeyT, typename ValueT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<
+                          std::pair<interval<KeyT, Comp>,
+                                    shared_value<ValueT> > > >
+    using flat_shared_map = flat_map<KeyT, shared_value<ValueT>, Comp, AllocT>;
 }
 
 #ifdef INTERVALS_TOP_NANESPACE
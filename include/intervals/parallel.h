@@ -0,0 +1,457 @@
+#ifndef ETOOL_INTERVALS_PARALLEL_H
+#define ETOOL_INTERVALS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "intervals/tree.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    namespace detail {
+
+        /// keeps the pieces as maximal runs: the overlapped
+        /// and the connected pieces are fused
+        template <typename KeyT>
+        class run_appender {
+
+        public:
+
+            explicit run_appender( std::vector<KeyT> &res )
+                :res_(res)
+            { }
+
+            void operator ( )( const KeyT &key )
+            {
+                using cmp = typename KeyT::cmp;
+                using nov = typename KeyT::cmp_not_overlap;
+
+                if( key.empty( ) ) {
+                    return;
+                }
+                if( !res_.empty( ) ) {
+                    KeyT &last = res_.back( );
+                    if( !nov::less( last, key )
+                      || key.left_connected( last ) )
+                    {
+                        if( cmp::less_right( last, key ) ) {
+                            last.replace_right( key );
+                        }
+                        return;
+                    }
+                }
+                res_.push_back( key );
+            }
+
+        private:
+            std::vector<KeyT> &res_;
+        };
+
+        /// the common part of two overlapped intervals
+        template <typename KeyT>
+        KeyT common( const KeyT &lh, const KeyT &rh )
+        {
+            using cmp = typename KeyT::cmp;
+            const KeyT &lo = cmp::less_left( lh, rh )  ? rh : lh;
+            const KeyT &hi = cmp::less_right( lh, rh ) ? lh : rh;
+            return KeyT::intersection( lo, hi );
+        }
+
+        /// the elements of 'src' clipped to 'slice'
+        template <typename SetT>
+        std::vector<typename SetT::key_type>
+        clip( const SetT &src, const typename SetT::key_type &slice )
+        {
+            std::vector<typename SetT::key_type> res;
+            for( auto elem: src.intersect_view( slice ) ) {
+                if( !elem.first.empty( ) ) {
+                    res.push_back( elem.first );
+                }
+            }
+            return res;
+        }
+
+        enum class set_operation { UNION, INTERSECTION, DIFFERENCE };
+
+        /// one linear walk over the pieces of both sets in one slice
+        template <typename KeyT>
+        void sweep( const std::vector<KeyT> &a, const std::vector<KeyT> &b,
+                    set_operation op, std::vector<KeyT> &res )
+        {
+            using cmp = typename KeyT::cmp;
+            using nov = typename KeyT::cmp_not_overlap;
+
+            run_appender<KeyT> out( res );
+            auto ia = a.begin( );
+            auto ib = b.begin( );
+
+            if( op == set_operation::UNION ) {
+                while( ia != a.end( ) || ib != b.end( ) ) {
+                    if( ib == b.end( )
+                     || ( ia != a.end( ) && cmp::less_left( *ia, *ib ) ) )
+                    {
+                        out( *ia++ );
+                    } else {
+                        out( *ib++ );
+                    }
+                }
+                return;
+            }
+
+            if( op == set_operation::INTERSECTION ) {
+                while( ia != a.end( ) && ib != b.end( ) ) {
+                    if( nov::less( *ia, *ib ) ) {
+                        ++ia;
+                    } else if( nov::less( *ib, *ia ) ) {
+                        ++ib;
+                    } else {
+                        out( common( *ia, *ib ) );
+                        if( cmp::less_right( *ia, *ib ) ) {
+                            ++ia;
+                        } else {
+                            ++ib;
+                        }
+                    }
+                }
+                return;
+            }
+
+            /// the rest of the current element of 'a'
+            KeyT rest;
+            if( ia != a.end( ) ) {
+                rest = *ia;
+            }
+            while( ia != a.end( ) ) {
+                if( ib == b.end( ) || nov::less( rest, *ib ) ) {
+                    out( rest );
+                    if( ++ia != a.end( ) ) {
+                        rest = *ia;
+                    }
+                    continue;
+                }
+                if( nov::less( *ib, rest ) ) {
+                    ++ib;
+                    continue;
+                }
+                if( rest.contains_left( *ib ) ) {
+                    out( rest.connect_right( *ib ) );
+                }
+                if( rest.contains_right( *ib ) ) {
+                    KeyT tail = rest.connect_left( *ib );
+                    ++ib;
+                    if( !tail.empty( ) ) {
+                        rest = std::move(tail);
+                        continue;
+                    }
+                }
+                if( ++ia != a.end( ) ) {
+                    rest = *ia;
+                }
+            }
+        }
+
+        /// the key at 'rank' in the merged order of 'a' and 'b' by the left
+        /// ends: 'i' elements of 'a' and 'rank - i' of 'b' come before it.
+        /// 'i' is found by a binary search, so it's O(log n)
+        template <typename ItrT>
+        ItrT merged_at( ItrT a, std::size_t na, ItrT b, std::size_t nb,
+                        std::size_t rank )
+        {
+            using key_type = typename std::iterator_traits<ItrT>::value_type;
+            using cmp      = typename key_type::cmp;
+
+            std::size_t lo = ( rank > nb ) ? rank - nb : 0;
+            std::size_t hi = std::min( rank, na );
+            while( lo < hi ) {
+                const std::size_t i = lo + ( hi - lo ) / 2;
+                if( cmp::less_left( a[i], b[rank - i - 1] ) ) {
+                    lo = i + 1;
+                } else {
+                    hi = i;
+                }
+            }
+            const std::size_t j = rank - lo;
+            if( lo == na ) {
+                return b + j;
+            }
+            if( j == nb || !cmp::less_left( b[j], a[lo] ) ) {
+                return a + lo;
+            }
+            return b + j;
+        }
+
+        /// the left ends of the evenly spaced elements of both sets
+        template <typename SetT>
+        std::vector<typename SetT::key_type>
+        pick_bounds( const SetT &a, const SetT &b, std::size_t count,
+                     std::random_access_iterator_tag )
+        {
+            const std::size_t total = a.size( ) + b.size( );
+            std::vector<typename SetT::key_type> bounds;
+            for( std::size_t i = 1; i < count; i++ ) {
+                const std::size_t rank = total * i / count;
+                if( rank == total ) {
+                    break;
+                }
+                bounds.push_back( *merged_at( a.begin( ), a.size( ),
+                                              b.begin( ), b.size( ),
+                                              rank ) );
+            }
+            return bounds;
+        }
+
+        /// the first element of 'src' that starts at 'point' or later;
+        /// one lower bound, O(log n)
+        template <typename SetT>
+        typename SetT::const_iterator
+        starts_from( const SetT &src, const typename SetT::key_type &point )
+        {
+            using cmp = typename SetT::key_type::cmp;
+
+            auto itr = src.find_intersection( point ).first;
+            if( itr != src.end( ) && cmp::less_left( *itr, point ) ) {
+                ++itr;
+            }
+            return itr;
+        }
+
+        /// the smallest and the largest finite ends of the first
+        /// and the last elements of 'src'
+        template <typename SetT, typename DomainT>
+        void finite_span( const SetT &src, bool &found,
+                          DomainT &lo, DomainT &hi )
+        {
+            if( src.empty( ) ) {
+                return;
+            }
+            auto add = [&]( const DomainT &val ) {
+                if( !found || val < lo ) {
+                    lo = val;
+                }
+                if( !found || hi < val ) {
+                    hi = val;
+                }
+                found = true;
+            };
+            for( auto &key: { *src.begin( ), *std::prev(src.end( )) } ) {
+                if( key.left_attr( ) != attributes::MIN_INF ) {
+                    add( key.left( ) );
+                }
+                if( key.right_attr( ) != attributes::MAX_INF ) {
+                    add( key.right( ) );
+                }
+            }
+        }
+
+        /// No random access and no subtree sizes, but an arithmetic
+        /// domain: the span of both sets is cut into equal pieces
+        /// and every piece starts at the next element of either set,
+        /// found with a lower bound in both of them. O(count * log(n))
+        template <typename SetT>
+        std::vector<typename SetT::key_type>
+        pick_bounds( const SetT &a, const SetT &b, std::size_t count,
+                     std::bidirectional_iterator_tag, std::true_type )
+        {
+            using key_type    = typename SetT::key_type;
+            using domain_type = typename key_type::domain_type;
+            using cmp         = typename key_type::cmp;
+            using integral    = typename std::is_integral<domain_type>::type;
+
+            std::vector<key_type> bounds;
+            bool found = false;
+            domain_type lo = domain_type( );
+            domain_type hi = domain_type( );
+            finite_span( a, found, lo, hi );
+            finite_span( b, found, lo, hi );
+            if( !found ) {
+                return bounds;
+            }
+
+            for( std::size_t i = 1; i < count; i++ ) {
+                const key_type point( span_point( lo, hi, i, count,
+                                                  integral( ) ) );
+                auto ia = starts_from( a, point );
+                auto ib = starts_from( b, point );
+                if( ia == a.end( ) && ib == b.end( ) ) {
+                    break;
+                }
+                if( ib == b.end( )
+                 || ( ia != a.end( ) && cmp::less_left( *ia, *ib ) ) )
+                {
+                    bounds.push_back( *ia );
+                } else {
+                    bounds.push_back( *ib );
+                }
+            }
+            return bounds;
+        }
+
+        /// the domains that can't be cut into equal pieces:
+        /// the larger set is walked once
+        template <typename SetT>
+        std::vector<typename SetT::key_type>
+        pick_bounds( const SetT &a, const SetT &b, std::size_t count,
+                     std::bidirectional_iterator_tag, std::false_type )
+        {
+            const SetT &big = ( a.size( ) < b.size( ) ) ? b : a;
+            std::vector<typename SetT::key_type> bounds;
+
+            auto itr = big.begin( );
+            std::size_t pos = 0;
+            for( std::size_t i = 1; i < count; i++ ) {
+                std::size_t next = big.size( ) * i / count;
+                if( next == pos && i > 1 ) {
+                    continue;
+                }
+                std::advance( itr, next - pos );
+                pos = next;
+                if( itr == big.end( ) ) {
+                    break;
+                }
+                bounds.push_back( *itr );
+            }
+            return bounds;
+        }
+
+        template <typename SetT>
+        std::vector<typename SetT::key_type>
+        pick_bounds( const SetT &a, const SetT &b, std::size_t count,
+                     std::bidirectional_iterator_tag tag )
+        {
+            using domain_type = typename SetT::key_type::domain_type;
+            using arithmetic  = typename std::is_arithmetic<domain_type>::type;
+            return pick_bounds( a, b, count, tag, arithmetic( ) );
+        }
+
+        /// Splits the domain at the left ends of evenly spaced elements
+        /// of both sets; the slices cover the whole domain
+        /// and don't overlap. The flat sets are split by rank with binary
+        /// searches, the others at equal steps of the domain with lower
+        /// bounds; only the non-arithmetic domains walk the larger set
+        template <typename SetT>
+        std::vector<typename SetT::key_type>
+        make_slices( const SetT &a, const SetT &b, std::size_t count )
+        {
+            using key_type = typename SetT::key_type;
+            using cmp      = typename key_type::cmp;
+            using category = typename std::iterator_traits<
+                                typename SetT::const_iterator
+                             >::iterator_category;
+
+            std::vector<key_type> res;
+            key_type from = key_type::infinite( );
+            for( auto &bound: pick_bounds( a, b, count, category( ) ) ) {
+                if( !cmp::less_left( from, bound ) ) {
+                    continue;
+                }
+                res.push_back( from.connect_right( bound ) );
+                from = key_type::intersection( bound, key_type::infinite( ) );
+            }
+            res.push_back( from );
+            return res;
+        }
+
+        template <typename SetT>
+        SetT parallel_apply( const SetT &a, const SetT &b,
+                             set_operation op, std::size_t threads )
+        {
+            using key_type = typename SetT::key_type;
+
+            if( threads == 0 ) {
+                threads = std::max<std::size_t>( 1,
+                                        std::thread::hardware_concurrency( ) );
+            }
+
+            /// a few slices per thread, so a dense slice doesn't
+            /// hold everybody back
+            auto slices = make_slices( a, b, threads * 4 );
+            std::vector<std::vector<key_type> > parts(slices.size( ));
+
+            std::atomic<std::size_t> next( 0 );
+            auto worker = [&]( ) {
+                std::size_t id;
+                while( ( id = next++ ) < slices.size( ) ) {
+                    sweep( clip( a, slices[id] ), clip( b, slices[id] ),
+                           op, parts[id] );
+                }
+            };
+
+            std::vector<std::thread> pool;
+            for( std::size_t t = 1; t < std::min( threads, slices.size( ) );
+                 t++ )
+            {
+                pool.emplace_back( worker );
+            }
+            worker( );
+            for( auto &t: pool ) {
+                t.join( );
+            }
+
+            /// the slices are in order; only the pieces at the bounds
+            /// of the slices can be fused
+            std::vector<key_type> runs;
+            run_appender<key_type> out( runs );
+            for( auto &part: parts ) {
+                for( auto &key: part ) {
+                    out( key );
+                }
+            }
+
+            SetT res;
+            for( auto &key: runs ) {
+                res.insert( res.end( ), std::move(key) );
+            }
+            return res;
+        }
+    }
+
+    /// Set algebra over two sets on 'threads' threads
+    /// (0 is the number of the cores).
+    /// The domain is split into slices at the elements of both sets,
+    /// every slice is walked linearly by its own task, the elements that
+    /// straddle a bound are clipped to both slices and fused back
+    /// when the slices are concatenated. The results are maximal runs:
+    /// the overlapped and the connected pieces are fused
+    template <typename SetT>
+    SetT parallel_union( const SetT &a, const SetT &b,
+                         std::size_t threads = 0 )
+    {
+        return detail::parallel_apply( a, b, detail::set_operation::UNION,
+                                       threads );
+    }
+
+    template <typename SetT>
+    SetT parallel_intersection( const SetT &a, const SetT &b,
+                                std::size_t threads = 0 )
+    {
+        return detail::parallel_apply( a, b,
+                                       detail::set_operation::INTERSECTION,
+                                       threads );
+    }
+
+    /// the points of 'a' that are not in 'b'
+    template <typename SetT>
+    SetT parallel_difference( const SetT &a, const SetT &b,
+                              std::size_t threads = 0 )
+    {
+        return detail::parallel_apply( a, b,
+                                       detail::set_operation::DIFFERENCE,
+                                       threads );
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // PARALLEL_H
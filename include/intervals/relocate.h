@@ -0,0 +1,164 @@
+#ifndef ETOOL_INTERVALS_RELOCATE_H
+#define ETOOL_INTERVALS_RELOCATE_H
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// The values that can be moved to another place by copying
+    /// their bytes; the old bytes are then forgotten without
+    /// the destructor. The flat sets and maps shift such values with
+    /// 'memmove'. Specialize it for the mapped types of the maps
+    /// that are relocatable but not trivially copyable, for example
+    /// the ones that own a pointer
+    template <typename T>
+    struct is_trivially_relocatable:
+        std::integral_constant<bool, std::is_trivially_copyable<T>::value>
+    { };
+
+    template <typename FirstT, typename SecondT>
+    struct is_trivially_relocatable<std::pair<FirstT, SecondT> >:
+        std::integral_constant<bool,
+                               is_trivially_relocatable<FirstT>::value
+                            && is_trivially_relocatable<SecondT>::value>
+    { };
+
+    namespace detail {
+
+        /// contiguous storage of the relocatable values
+        template <typename ArrayT>
+        struct relocatable_array: std::false_type { };
+
+        template <typename T, typename AllocT>
+        struct relocatable_array<std::vector<T, AllocT> >:
+            is_trivially_relocatable<T>
+        { };
+
+        template <typename ArrayT>
+        typename ArrayT::iterator
+        array_insert( ArrayT &arr, typename ArrayT::const_iterator where,
+                      typename ArrayT::value_type &&val, std::false_type )
+        {
+            return arr.emplace( where, std::move(val) );
+        }
+
+        /// The new value is appended (the vector grows as usual)
+        /// and moved to its place: the tail is shifted by one memmove
+        template <typename ArrayT>
+        typename ArrayT::iterator
+        array_insert( ArrayT &arr, typename ArrayT::const_iterator where,
+                      typename ArrayT::value_type &&val, std::true_type )
+        {
+            using value_type = typename ArrayT::value_type;
+
+            const std::size_t pos = where - arr.cbegin( );
+            arr.emplace_back( std::move(val) );
+
+            const std::size_t tail = arr.size( ) - 1 - pos;
+            if( tail != 0 ) {
+                value_type *data = arr.data( );
+                typename std::aligned_storage<sizeof(value_type),
+                                              alignof(value_type)>::type tmp;
+                std::memcpy( &tmp, static_cast<void *>( data + pos + tail ),
+                             sizeof(value_type) );
+                std::memmove( static_cast<void *>( data + pos + 1 ),
+                              static_cast<void *>( data + pos ),
+                              tail * sizeof(value_type) );
+                std::memcpy( static_cast<void *>( data + pos ), &tmp,
+                             sizeof(value_type) );
+            }
+            return arr.begin( ) + pos;
+        }
+
+        template <typename ArrayT>
+        typename ArrayT::iterator
+        array_erase( ArrayT &arr, typename ArrayT::const_iterator from,
+                     typename ArrayT::const_iterator to, std::false_type )
+        {
+            return arr.erase( from, to );
+        }
+
+        /// The erased values need no destructor: the tail is shifted
+        /// over them by one memmove and the end is cut off
+        template <typename ArrayT>
+        void array_shift( ArrayT &arr, std::size_t pos, std::size_t count,
+                          std::true_type )
+        {
+            using value_type = typename ArrayT::value_type;
+
+            const std::size_t tail = arr.size( ) - pos - count;
+            value_type *data = arr.data( );
+            std::memmove( static_cast<void *>( data + pos ),
+                          static_cast<void *>( data + pos + count ),
+                          tail * sizeof(value_type) );
+        }
+
+        /// The erased values are moved to the end, so every value
+        /// is destroyed once when the end is cut off. Up to
+        /// 'buffer_size' bytes of them are put aside on the stack
+        /// and the tail is shifted by one memmove; more are rotated
+        /// as raw bytes. Nothing is allocated
+        template <typename ArrayT>
+        void array_shift( ArrayT &arr, std::size_t pos, std::size_t count,
+                          std::false_type )
+        {
+            using value_type = typename ArrayT::value_type;
+            using raw_type   = typename std::aligned_storage<
+                                            sizeof(value_type),
+                                            alignof(value_type)>::type;
+
+            static const std::size_t buffer_size = 256;
+            static const std::size_t capacity =
+                    sizeof(raw_type) < buffer_size
+                  ? buffer_size / sizeof(raw_type) : 1;
+
+            const std::size_t tail = arr.size( ) - pos - count;
+            raw_type *data = reinterpret_cast<raw_type *>( arr.data( ) );
+            if( count > capacity ) {
+                std::rotate( data + pos, data + pos + count,
+                             data + pos + count + tail );
+                return;
+            }
+
+            raw_type tmp[capacity];
+            std::memcpy( tmp, data + pos, count * sizeof(raw_type) );
+            std::memmove( data + pos, data + pos + count,
+                          tail * sizeof(raw_type) );
+            std::memcpy( data + pos + tail, tmp, count * sizeof(raw_type) );
+        }
+
+        template <typename ArrayT>
+        typename ArrayT::iterator
+        array_erase( ArrayT &arr, typename ArrayT::const_iterator from,
+                     typename ArrayT::const_iterator to, std::true_type )
+        {
+            using value_type = typename ArrayT::value_type;
+            using trivial    = typename std::is_trivially_destructible<
+                                                        value_type>::type;
+
+            const std::size_t pos   = from - arr.cbegin( );
+            const std::size_t count = to - from;
+            if( count != 0 && pos + count != arr.size( ) ) {
+                array_shift( arr, pos, count, trivial( ) );
+            }
+            arr.erase( arr.end( ) - count, arr.end( ) );
+            return arr.begin( ) + pos;
+        }
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // RELOCATE_H
@@ -0,0 +1,142 @@
+#ifndef ETOOL_INTERVALS_SEARCH_H
+#define ETOOL_INTERVALS_SEARCH_H
+
+#include <algorithm>
+#include <iterator>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals { namespace search {
+
+    /// how many steps bidirectional iterators are allowed to walk
+    /// away from the hint before the caller should give up
+    /// and ask the container for a full search
+    static const std::size_t near_steps = 4;
+
+    namespace detail {
+
+        /// binary search over iterators. 'pred' takes an iterator
+        template <typename ItrT, typename PredT>
+        ItrT bisect( ItrT first, ItrT last, PredT pred )
+        {
+            using diff_type =
+                    typename std::iterator_traits<ItrT>::difference_type;
+            diff_type len = last - first;
+            while( len > 0 ) {
+                diff_type half = len / 2;
+                ItrT middle = first + half;
+                if( pred( middle ) ) {
+                    first = middle + 1;
+                    len  -= half + 1;
+                } else {
+                    len = half;
+                }
+            }
+            return first;
+        }
+
+        /// random access iterators: exponential search from the hint.
+        /// always succeeds; costs O(log d) where d is the distance
+        /// between the hint and the result
+        template <typename ItrT, typename PredT>
+        bool partition_point_near( ItrT first, ItrT hint, ItrT last,
+                                   PredT pred, std::size_t,
+                                   ItrT &result,
+                                   std::random_access_iterator_tag )
+        {
+            using diff_type =
+                    typename std::iterator_traits<ItrT>::difference_type;
+
+            if( hint != last && pred( hint ) ) {
+                /// the point is to the right. hint is known as 'true'
+                ItrT lo = hint;
+                diff_type step = 1;
+                while( true ) {
+                    diff_type rest = last - lo;
+                    ItrT probe = ( step < rest ) ? lo + step : last;
+                    if( probe == last || !pred( probe ) ) {
+                        result = bisect( lo + 1, probe, pred );
+                        return true;
+                    }
+                    lo = probe;
+                    step *= 2;
+                }
+            }
+
+            /// the point is here or to the left. hint is known as 'false'
+            ItrT hi = hint;
+            diff_type step = 1;
+            while( hi != first ) {
+                diff_type rest = hi - first;
+                ItrT probe = ( step < rest ) ? hi - step : first;
+                if( pred( probe ) ) {
+                    result = bisect( probe + 1, hi, pred );
+                    return true;
+                }
+                hi = probe;
+                step *= 2;
+            }
+            result = first;
+            return true;
+        }
+
+        /// bidirectional iterators: walk at most 'steps' elements.
+        /// fails if the point is farther away
+        template <typename ItrT, typename PredT>
+        bool partition_point_near( ItrT first, ItrT hint, ItrT last,
+                                   PredT pred, std::size_t steps,
+                                   ItrT &result,
+                                   std::bidirectional_iterator_tag )
+        {
+            if( hint != last && pred( hint ) ) {
+                ++hint;
+                for( std::size_t i = 0; i < steps; ++i, ++hint ) {
+                    if( hint == last || !pred( hint ) ) {
+                        result = hint;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            for( std::size_t i = 0; i < steps; ++i ) {
+                if( hint == first ) {
+                    result = hint;
+                    return true;
+                }
+                ItrT prev = std::prev( hint );
+                if( pred( prev ) ) {
+                    result = hint;
+                    return true;
+                }
+                hint = prev;
+            }
+            return false;
+        }
+    }
+
+    /// Finds the partition point of [first, last) starting from 'hint'.
+    /// 'pred' is called with an iterator and must be 'true' for
+    /// all the elements before the point and 'false' after it.
+    /// Returns false if the point is too far for the iterator category;
+    /// 'result' is untouched in this case.
+    template <typename ItrT, typename PredT>
+    bool partition_point_near( ItrT first, ItrT hint, ItrT last,
+                               PredT pred, ItrT &result,
+                               std::size_t steps = near_steps )
+    {
+        using category =
+                typename std::iterator_traits<ItrT>::iterator_category;
+        return detail::partition_point_near( first, hint, last, pred,
+                                             steps, result, category( ) );
+    }
+
+}}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // SEARCH_H
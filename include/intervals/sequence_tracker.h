@@ -0,0 +1,118 @@
+#ifndef ETOOL_INTERVALS_SEQUENCE_TRACKER_H
+#define ETOOL_INTERVALS_SEQUENCE_TRACKER_H
+
+#include <cstdint>
+#include <deque>
+
+#include "intervals/set.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Tracks received ranges [from, to) of a sequence.
+    /// The watermark is the end of the contiguous prefix from the origin;
+    /// only the ranges above it are kept. They live in a set
+    /// over 'std::deque', so the ranges that reach the watermark leave
+    /// from the front of the array without any rebalancing.
+    ///     'watermark'             O(1)
+    ///     'receive' at the mark   amortized O(1)
+    ///     'receive' near the end  O(log distance) from the last range
+    template <typename KeyT = std::uint64_t, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<interval<KeyT, Comp> > >
+    class sequence_tracker {
+
+        using array_type = std::deque<interval<KeyT, Comp>, AllocT>;
+        using layout     = typename default_layout<KeyT>::type;
+        using trait_type = traits::array_set<KeyT, Comp, AllocT, layout,
+                                             array_type>;
+
+    public:
+
+        using domain_type   = KeyT;
+        using set_type      = set<KeyT, Comp, AllocT, trait_type>;
+        using key_type      = typename set_type::key_type;
+
+        explicit sequence_tracker( domain_type origin = domain_type( ) )
+            :watermark_(std::move(origin))
+        { }
+
+        /// everything before it is received
+        const domain_type &watermark( ) const
+        {
+            return watermark_;
+        }
+
+        void receive( const domain_type &from, const domain_type &to )
+        {
+            using cmp = typename key_type::cmp;
+
+            if( !cmp::less( watermark_, to ) ) {
+                return;
+            }
+            if( !cmp::less( watermark_, from ) ) {
+                watermark_ = to;
+            } else {
+                pending_.absorb( pending_.end( ),
+                                 key_type::left_closed( from, to ) );
+            }
+            drop_front( );
+        }
+
+        /// moves the watermark to 'to' as if everything before it
+        /// was received
+        void advance( const domain_type &to )
+        {
+            using cmp = typename key_type::cmp;
+
+            if( cmp::less( watermark_, to ) ) {
+                watermark_ = to;
+                drop_front( );
+            }
+        }
+
+        bool received( const domain_type &val ) const
+        {
+            using cmp = typename key_type::cmp;
+
+            return cmp::less( val, watermark_ )
+                || ( pending_.find( val ) != pending_.end( ) );
+        }
+
+        /// the ranges above the watermark
+        const set_type &pending( ) const
+        {
+            return pending_;
+        }
+
+    private:
+
+        /// the ranges that reach the watermark move it
+        void drop_front( )
+        {
+            using cmp = typename key_type::cmp;
+
+            auto itr = pending_.begin( );
+            for( ; itr != pending_.end( )
+                && !cmp::less( watermark_, itr->left( ) ); ++itr )
+            {
+                if( cmp::less( watermark_, itr->right( ) ) ) {
+                    watermark_ = itr->right( );
+                }
+            }
+            pending_.erase( pending_.begin( ), itr );
+        }
+
+        domain_type watermark_;
+        set_type    pending_;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // SEQUENCE_TRACKER_H
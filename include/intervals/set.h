@@ -4,6 +4,7 @@
 #include "intervals/tree.h"
 #include "intervals/traits/std_set.h"
 #include "intervals/traits/array_set.h"
+#include "intervals/traits/ranked_set.h"
 
 #ifdef INTERVALS_TOP_NANESPACE
 namespace INTERVALS_TOP_NANESPACE {
@@ -12,15 +13,16 @@ namespace INTERVALS_TOP_NANESPACE {
 namespace intervals {
 
     template <typename KeyT, typename Comp = std::less<KeyT>,
-              typename AllocT = std::allocator<KeyT> >
-    class set: public tree<traits::std_set<KeyT, Comp, AllocT> > {
+              typename AllocT = std::allocator<KeyT>,
+              typename TraitT = traits::std_set<KeyT, Comp, AllocT> >
+    class set: public tree<TraitT> {
 
-        using parent_type = tree<traits::std_set<KeyT, Comp, AllocT> >;
-        using key_type    = typename parent_type::key_type;
+        using parent_type = tree<TraitT>;
 
     public:
 
         using domain_type       = KeyT;
+        using key_type          = typename parent_type::key_type;
         using iterator          = typename parent_type::iterator;
         using const_iterator    = typename parent_type::const_iterator;
 
@@ -42,6 +44,18 @@ namespace intervals {
             return parent_type::insert_impl(std::move(k) );
         }
 
+        /// hinted versions. the search starts from 'hint' and the result
+        /// is a good hint for the next neighbouring value
+        iterator insert( const_iterator hint, domain_type k )
+        {
+            return insert(hint, key_type( std::move(k) ));
+        }
+
+        iterator insert( const_iterator hint, key_type k )
+        {
+            return parent_type::insert_impl( hint, std::move(k) );
+        }
+
         template <typename IterT>
         void merge( IterT begin, IterT end )
         {
@@ -60,6 +74,16 @@ namespace intervals {
             return parent_type::merge_impl( std::move(k) );
         }
 
+        iterator merge( const_iterator hint, domain_type k )
+        {
+            return merge(hint, key_type( std::move(k) ));
+        }
+
+        iterator merge( const_iterator hint, key_type k )
+        {
+            return parent_type::merge_impl( hint, std::move(k) );
+        }
+
         template <typename IterT>
         void absorb( IterT begin, IterT end )
         {
@@ -78,6 +102,16 @@ namespace intervals {
             return parent_type::absorb_impl( std::move(k) );
         }
 
+        iterator absorb( const_iterator hint, domain_type k )
+        {
+            return absorb(hint, key_type( std::move(k) ));
+        }
+
+        iterator absorb( const_iterator hint, key_type k )
+        {
+            return parent_type::absorb_impl( hint, std::move(k) );
+        }
+
         template <typename IterT>
         void cut( IterT begin, IterT end )
         {
@@ -95,7 +129,29 @@ namespace intervals {
         {
             return parent_type::cut_impl( std::move(k) );
         }
+
+        iterator cut( const_iterator hint, const domain_type& k )
+        {
+            return cut(hint, key_type::degenerate( k ));
+        }
+
+        iterator cut( const_iterator hint, key_type k )
+        {
+            return parent_type::cut_impl( hint, std::move(k) );
+        }
     };
+
+    /// the same set but stored in a sorted array
+    template <typename KeyT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<interval<KeyT, Comp> > >
+    using flat_set = set<KeyT, Comp, AllocT,
+                         traits::array_set<KeyT, Comp, AllocT> >;
+
+    /// the same set in a treap; 'partition' is O(count * log(n))
+    template <typename KeyT, typename Comp = std::less<KeyT>,
+              typename AllocT = std::allocator<interval<KeyT, Comp> > >
+    using ranked_set = set<KeyT, Comp, AllocT,
+                           traits::ranked_set<KeyT, Comp, AllocT> >;
 }
 
 #ifdef INTERVALS_TOP_NANESPACE
@@ -0,0 +1,96 @@
+#ifndef ETOOL_INTERVALS_SHARED_VALUE_H
+#define ETOOL_INTERVALS_SHARED_VALUE_H
+
+#include <memory>
+#include <utility>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Copy-on-write holder for big mapped values.
+    /// A copy shares the payload, so splitting an element into pieces
+    /// costs reference count bumps. The payload is copied by 'mutate'
+    /// only if it is shared. The default value doesn't allocate.
+    /// Like 'std::shared_ptr', one object must not be mutated
+    /// from several threads at once
+    template <typename ValueT>
+    class shared_value {
+
+    public:
+
+        using value_type = ValueT;
+
+        shared_value( ) = default;
+
+        shared_value( value_type val )
+            :ptr_(std::make_shared<value_type>( std::move(val) ))
+        { }
+
+        const value_type &get( ) const
+        {
+            return ptr_ ? *ptr_ : empty_value( );
+        }
+
+        operator const value_type &( ) const
+        {
+            return get( );
+        }
+
+        const value_type &operator * ( ) const
+        {
+            return get( );
+        }
+
+        const value_type *operator -> ( ) const
+        {
+            return &get( );
+        }
+
+        /// the payload of this object only
+        value_type &mutate( )
+        {
+            if( !ptr_ ) {
+                ptr_ = std::make_shared<value_type>( );
+            } else if( ptr_.use_count( ) > 1 ) {
+                ptr_ = std::make_shared<value_type>( *ptr_ );
+            }
+            return *ptr_;
+        }
+
+        long use_count( ) const
+        {
+            return ptr_.use_count( );
+        }
+
+        /// the same payload is equal without comparing the values
+        bool operator == ( const shared_value &other ) const
+        {
+            return ( ptr_ == other.ptr_ ) || ( get( ) == other.get( ) );
+        }
+
+        bool operator != ( const shared_value &other ) const
+        {
+            return !( *this == other );
+        }
+
+    private:
+
+        static const value_type &empty_value( )
+        {
+            static const value_type value{ };
+            return value;
+        }
+
+        std::shared_ptr<value_type> ptr_;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // SHARED_VALUE_H
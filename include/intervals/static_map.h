@@ -0,0 +1,169 @@
+#ifndef ETOOL_INTERVALS_STATIC_MAP_H
+#define ETOOL_INTERVALS_STATIC_MAP_H
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "intervals/interval.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    namespace detail {
+
+        template <std::size_t ...Ids>
+        struct index_list { };
+
+        template <std::size_t N, std::size_t ...Ids>
+        struct make_index_list: make_index_list<N - 1, N - 1, Ids...> { };
+
+        template <std::size_t ...Ids>
+        struct make_index_list<0, Ids...> {
+            using type = index_list<Ids...>;
+        };
+    }
+
+    /// Immutable interval map with no startup cost: it's built
+    /// in a constant expression from an array of N pairs
+    /// {interval, value}. The array must be sorted and the intervals
+    /// must not overlap or be empty; a bad array doesn't compile
+    /// if the map is 'constexpr' and throws 'std::logic_error' otherwise.
+    /// The domain must be arithmetic with 'std::less' and the mapped
+    /// type must be a literal type.
+    /// 'lookup' works in the constant expressions,
+    /// 'find' is the branch-free binary search for the run time
+    template <typename KeyT, typename ValueT, std::size_t N,
+              typename Comp = std::less<KeyT> >
+    class static_interval_map {
+
+        static_assert( N > 0, "Static interval map. The map is empty." );
+
+    public:
+
+        using domain_type       = KeyT;
+        using mapped_type       = ValueT;
+        using key_type          = interval<KeyT, Comp>;
+        using value_type        = std::pair<key_type, ValueT>;
+        using const_iterator    = const value_type *;
+
+    private:
+
+        using cmp = typename key_type::cmp_not_overlap;
+
+    public:
+
+        constexpr
+        static_interval_map( const value_type (&src)[N] )
+            :static_interval_map(src,
+                                 typename detail::make_index_list<N>::type( ))
+        { }
+
+        constexpr
+        const_iterator begin( ) const
+        {
+            return data_;
+        }
+
+        constexpr
+        const_iterator end( ) const
+        {
+            return data_ + N;
+        }
+
+        constexpr
+        std::size_t size( ) const
+        {
+            return N;
+        }
+
+        /// the element that contains 'val' or 'end( )'
+        constexpr
+        const_iterator lookup( const domain_type &val ) const
+        {
+            return lookup( val, 0, N );
+        }
+
+        constexpr
+        bool contains( const domain_type &val ) const
+        {
+            return lookup( val ) != end( );
+        }
+
+        /// the same as 'lookup' without branches in the loop:
+        /// the half of the range is chosen by a conditional move
+        const_iterator find( const domain_type &val ) const
+        {
+            const key_type key( val );
+            const_iterator base = data_;
+            std::size_t count = N;
+            while( count > 1 ) {
+                const std::size_t half = count / 2;
+                base = cmp::less( base[half - 1].first, key )
+                     ? base + half
+                     : base;
+                count -= half;
+            }
+            return base->first.contains( val ) ? base : end( );
+        }
+
+    private:
+
+        template <std::size_t ...Ids>
+        constexpr
+        static_interval_map( const value_type (&src)[N],
+                             detail::index_list<Ids...> )
+            :data_{ checked( src, Ids )... }
+        { }
+
+        static constexpr
+        const value_type &checked( const value_type (&src)[N],
+                                   std::size_t id )
+        {
+            return ( src[id].first.valid( )
+                  && !src[id].first.empty( )
+                  && ( id == 0 || cmp::less( src[id - 1].first,
+                                             src[id].first ) ) )
+                 ? src[id]
+                 : throw std::logic_error( "Static interval map. "
+                                           "The intervals are not sorted, "
+                                           "overlapped or empty." );
+        }
+
+        constexpr
+        const_iterator lookup( const domain_type &val,
+                               std::size_t lo, std::size_t hi ) const
+        {
+            return ( lo == hi )
+                 ? end( )
+                 : data_[( lo + hi ) / 2].first.contains( val )
+                 ? data_ + ( lo + hi ) / 2
+                 : cmp::less( data_[( lo + hi ) / 2].first, key_type( val ) )
+                 ? lookup( val, ( lo + hi ) / 2 + 1, hi )
+                 : lookup( val, lo, ( lo + hi ) / 2 );
+        }
+
+        value_type data_[N];
+    };
+
+    template <typename KeyT, typename ValueT, std::size_t N,
+              typename Comp = std::less<KeyT> >
+    constexpr
+    static_interval_map<KeyT, ValueT, N, Comp>
+    make_static_interval_map(
+        const std::pair<interval<KeyT, Comp>, ValueT> (&src)[N] )
+    {
+        return static_interval_map<KeyT, ValueT, N, Comp>( src );
+    }
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // STATIC_MAP_H
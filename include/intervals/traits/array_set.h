@@ -2,8 +2,10 @@
 #define ETOOL_INTERVALS_TRAITS_ARRAY_SET_H
 
 #include <set>
+#include <type_traits>
 #include <vector>
 #include "intervals/interval.h"
+#include "intervals/relocate.h"
 
 #ifdef INTERVALS_TOP_NANESPACE
 namespace INTERVALS_TOP_NANESPACE {
@@ -11,14 +13,24 @@ namespace INTERVALS_TOP_NANESPACE {
 
 namespace intervals { namespace traits {
 
-    template <typename KeyT, typename Comparator, typename AllocT>
+    /// 'ArrayT' is any random access sequence of the intervals,
+    /// for example 'std::deque'
+    template <typename KeyT, typename Comparator, typename AllocT,
+              typename LayoutT = typename default_layout<KeyT>::type,
+              typename ArrayT = std::vector<
+                                    interval<KeyT, Comparator, LayoutT>,
+                                    AllocT> >
     struct array_set {
 
-        using interval_type     = interval<KeyT, Comparator>;
+        using interval_type     = interval<KeyT, Comparator, LayoutT>;
         using value_type        = interval_type;
 
+        static_assert( std::is_same<typename ArrayT::value_type,
+                                    value_type>::value,
+                       "The array must keep the intervals of the set" );
+
         using allocator_type    = AllocT;
-        using array_type        = std::vector<value_type, allocator_type>;
+        using array_type        = ArrayT;
         using iterator          = typename array_type::iterator;
         using const_iterator    = typename array_type::const_iterator;
 
@@ -29,6 +41,10 @@ namespace intervals { namespace traits {
             using iterator       = typename array_type::iterator;
             using const_iterator = typename array_type::const_iterator;
 
+            /// the values are shifted with memmove
+            using relocatable = typename detail::relocatable_array<
+                                                        array_type>::type;
+
             iterator begin( )
             {
                 return arr_.begin( );
@@ -84,6 +100,27 @@ namespace intervals { namespace traits {
                 return std::upper_bound( begin( ), end( ), val, set_cmp( ) );
             }
 
+            const_iterator lower_bound( const value_type &val ) const
+            {
+                return std::lower_bound( begin( ), end( ), val, set_cmp( ) );
+            }
+
+            const_iterator upper_bound( const value_type &val ) const
+            {
+                return std::upper_bound( begin( ), end( ), val, set_cmp( ) );
+            }
+
+            std::pair<iterator, iterator> equal_range( const value_type &val )
+            {
+                return std::equal_range( begin( ), end( ), val, set_cmp( ) );
+            }
+
+            std::pair<const_iterator, const_iterator>
+            equal_range( const value_type &val ) const
+            {
+                return std::equal_range( begin( ), end( ), val, set_cmp( ) );
+            }
+
             iterator find( const value_type &val )
             {
                 return std::binary_search( begin( ), end( ), val, set_cmp( ) );
@@ -107,7 +144,8 @@ namespace intervals { namespace traits {
                         lb = std::lower_bound( where, cend( ),
                                                val, set_cmp( ) );
                     }
-                    return arr_.emplace( lb, std::move(val) );
+                    return detail::array_insert( arr_, lb, std::move(val),
+                                                 relocatable( ) );
                 } else {
                     return arr_.emplace( arr_.end( ), std::move( val ) );
                 }
@@ -115,12 +153,13 @@ namespace intervals { namespace traits {
 
             iterator erase( const_iterator where )
             {
-                return arr_.erase( where );
+                return detail::array_erase( arr_, where, where + 1,
+                                            relocatable( ) );
             }
 
             iterator erase( const_iterator from, const_iterator to )
             {
-                return arr_.erase( from, to );
+                return detail::array_erase( arr_, from, to, relocatable( ) );
             }
 
             array_type arr_;
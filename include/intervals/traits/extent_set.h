@@ -0,0 +1,169 @@
+#ifndef ETOOL_INTERVALS_TRAITS_EXTENT_SET_H
+#define ETOOL_INTERVALS_TRAITS_EXTENT_SET_H
+
+#include <algorithm>
+#include <limits>
+#include "intervals/interval.h"
+#include "intervals/traits/treap.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals { namespace traits {
+
+    /// Every node knows the length of the longest interval of its subtree.
+    /// The length is the number of positions in the interval;
+    /// the infinite ends reach the limits of the domain
+    template <typename IntervalT>
+    struct extent_policy {
+
+        using interval_type = IntervalT;
+        using domain_type   = typename interval_type::domain_type;
+
+        struct data_type {
+            domain_type max_length = domain_type( );
+        };
+
+        /// the positions of 'ival' as [lo, hi)
+        static void bounds( const interval_type &ival,
+                            domain_type &lo, domain_type &hi )
+        {
+            using limits = std::numeric_limits<domain_type>;
+
+            switch( ival.left_attr( ) ) {
+            case attributes::MIN_INF:
+                lo = limits::lowest( );
+                break;
+            case attributes::OPEN:
+                lo = ( ival.left( ) == limits::max( ) )
+                   ? ival.left( ) : domain_type( ival.left( ) + 1 );
+                break;
+            default:
+                lo = ival.left( );
+                break;
+            }
+
+            switch( ival.right_attr( ) ) {
+            case attributes::MAX_INF:
+                hi = limits::max( );
+                break;
+            case attributes::CLOSE:
+                hi = ( ival.right( ) == limits::max( ) )
+                   ? ival.right( ) : domain_type( ival.right( ) + 1 );
+                break;
+            default:
+                hi = ival.right( );
+                break;
+            }
+        }
+
+        static domain_type length( const interval_type &ival )
+        {
+            if( ival.empty( ) ) {
+                return domain_type( );
+            }
+            domain_type lo;
+            domain_type hi;
+            bounds( ival, lo, hi );
+            return ( lo < hi ) ? domain_type( hi - lo ) : domain_type( );
+        }
+
+        template <typename NodeT>
+        static void push( NodeT * )
+        { }
+
+        template <typename NodeT>
+        static void pull( NodeT *n )
+        {
+            domain_type res = length( n->value );
+            if( n->left ) {
+                res = std::max( res, n->left->data.max_length );
+            }
+            if( n->right ) {
+                res = std::max( res, n->right->data.max_length );
+            }
+            n->data.max_length = res;
+        }
+    };
+
+    template <typename KeyT, typename Comparator, typename AllocT>
+    struct extent_set {
+
+        using interval_type     = interval<KeyT, Comparator>;
+        using value_type        = interval_type;
+        using set_cmp           = typename interval_type::cmp_not_overlap;
+        using allocator_type    = AllocT;
+        using policy_type       = extent_policy<interval_type>;
+
+        struct key_of {
+
+            using key_type = interval_type;
+
+            static
+            const key_type &get( const value_type &val )
+            {
+                return val;
+            }
+        };
+
+        using container_type    = treap<value_type, key_of, set_cmp,
+                                        policy_type, allocator_type>;
+        using iterator          = typename container_type::iterator;
+        using const_iterator    = typename container_type::const_iterator;
+
+        /// the lengths change with the keys; the container recomputes
+        /// them on 'refresh'
+        struct iterator_access {
+
+            static
+            const interval_type &key( const_iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            interval_type &mutable_key( iterator itr )
+            {
+                container_type::touch( itr );
+                return *itr;
+            }
+
+            static
+            const interval_type &key( const value_type &val )
+            {
+                return val;
+            }
+
+            static
+            interval_type &mutable_key( value_type &val )
+            {
+                return val;
+            }
+
+            static
+            void copy( value_type &, const value_type & )
+            { }
+
+            static
+            const value_type &val( const_iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            value_type &mutable_val( iterator itr )
+            {
+                container_type::touch( itr );
+                return *itr;
+            }
+        };
+    };
+
+}}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // EXTENT_SET_H
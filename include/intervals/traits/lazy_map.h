@@ -0,0 +1,194 @@
+#ifndef ETOOL_INTERVALS_TRAITS_LAZY_MAP_H
+#define ETOOL_INTERVALS_TRAITS_LAZY_MAP_H
+
+#include <algorithm>
+#include "intervals/interval.h"
+#include "intervals/traits/treap.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    /// Operations for the lazy map. Every one has
+    ///     'apply(value, tag)'  changes the value,
+    ///     'compose(tag, next)' makes 'tag' do 'tag' and then 'next'.
+    namespace lazy {
+
+        template <typename T>
+        struct add {
+
+            using tag_type = T;
+
+            static void apply( T &value, const tag_type &tag )
+            {
+                value = value + tag;
+            }
+
+            static void compose( tag_type &tag, const tag_type &next )
+            {
+                tag = tag + next;
+            }
+        };
+
+        template <typename T>
+        struct max {
+
+            using tag_type = T;
+
+            static void apply( T &value, const tag_type &tag )
+            {
+                value = std::max( value, tag );
+            }
+
+            static void compose( tag_type &tag, const tag_type &next )
+            {
+                tag = std::max( tag, next );
+            }
+        };
+
+        template <typename T>
+        struct assign {
+
+            using tag_type = T;
+
+            static void apply( T &value, const tag_type &tag )
+            {
+                value = tag;
+            }
+
+            static void compose( tag_type &tag, const tag_type &next )
+            {
+                tag = next;
+            }
+        };
+    }
+
+namespace traits {
+
+    /// Tags of a node are pending for its children;
+    /// the value of the node itself is always up to date
+    template <typename OpT>
+    struct lazy_policy {
+
+        using tag_type = typename OpT::tag_type;
+
+        struct data_type {
+            tag_type tag     = tag_type( );
+            bool     pending = false;
+        };
+
+        template <typename NodeT>
+        static void apply_tag( NodeT *n, const tag_type &tag )
+        {
+            OpT::apply( n->value.second, tag );
+            if( n->data.pending ) {
+                OpT::compose( n->data.tag, tag );
+            } else {
+                n->data.tag     = tag;
+                n->data.pending = true;
+            }
+        }
+
+        template <typename NodeT>
+        static void push( NodeT *n )
+        {
+            if( n->data.pending ) {
+                if( n->left ) {
+                    apply_tag( n->left, n->data.tag );
+                }
+                if( n->right ) {
+                    apply_tag( n->right, n->data.tag );
+                }
+                n->data.pending = false;
+            }
+        }
+
+        template <typename NodeT>
+        static void pull( NodeT * )
+        { }
+    };
+
+    template <typename KeyT, typename ValueT, typename OpT,
+              typename Comparator, typename AllocT>
+    struct lazy_map {
+
+        using interval_type     = interval<KeyT, Comparator>;
+        using map_cmp           = typename interval_type::cmp_not_overlap;
+        using value_type        = std::pair<const interval_type, ValueT>;
+
+        using op_type           = OpT;
+        using policy_type       = lazy_policy<op_type>;
+        using allocator_type    = AllocT;
+
+        struct key_of {
+
+            using key_type = interval_type;
+
+            static
+            const key_type &get( const value_type &val )
+            {
+                return val.first;
+            }
+        };
+
+        using container_type    = treap<value_type, key_of, map_cmp,
+                                        policy_type, allocator_type>;
+
+        using iterator          = typename container_type::iterator;
+        using const_iterator    = typename container_type::const_iterator;
+
+        struct iterator_access {
+
+            static
+            const interval_type &key( const_iterator itr )
+            {
+                return itr->first;
+            }
+
+            static
+            interval_type &mutable_key( iterator itr )
+            {
+                return const_cast<interval_type &>(itr->first);
+            }
+
+            static
+            const interval_type &key( const value_type &val )
+            {
+                return val.first;
+            }
+
+            static
+            interval_type &mutable_key( value_type &val )
+            {
+                return const_cast<interval_type &>(val.first);
+            }
+
+            static
+            void copy( value_type &to, const value_type &from )
+            {
+                to.second = from.second;
+            }
+
+            static
+            const value_type &val( const_iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            value_type &mutable_val( iterator itr )
+            {
+                return *itr;
+            }
+        };
+    };
+
+}}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // LAZY_MAP_H
@@ -0,0 +1,93 @@
+#ifndef ETOOL_INTERVALS_TRAITS_RANKED_MAP_H
+#define ETOOL_INTERVALS_TRAITS_RANKED_MAP_H
+
+#include "intervals/interval.h"
+#include "intervals/traits/treap.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals { namespace traits {
+
+    /// The map in a treap: the same as 'std_map', and the element
+    /// at a rank is found in O(log n)
+    template <typename KeyT, typename ValueT, typename Comparator,
+              typename AllocT,
+              typename LayoutT = typename default_layout<KeyT>::type>
+    struct ranked_map {
+
+        using interval_type     = interval<KeyT, Comparator, LayoutT>;
+        using map_cmp           = typename interval_type::cmp_not_overlap;
+        using value_type        = std::pair<const interval_type, ValueT>;
+        using allocator_type    = AllocT;
+
+        struct key_of {
+
+            using key_type = interval_type;
+
+            static
+            const key_type &get( const value_type &val )
+            {
+                return val.first;
+            }
+        };
+
+        using container_type    = treap<value_type, key_of, map_cmp,
+                                        no_augment, allocator_type>;
+        using iterator          = typename container_type::iterator;
+        using const_iterator    = typename container_type::const_iterator;
+
+        struct iterator_access {
+
+            static
+            const interval_type &key( const_iterator itr )
+            {
+                return itr->first;
+            }
+
+            static
+            interval_type &mutable_key( iterator itr )
+            {
+                return const_cast<interval_type &>(itr->first);
+            }
+
+            static
+            const interval_type &key( const value_type &val )
+            {
+                return val.first;
+            }
+
+            static
+            interval_type &mutable_key( value_type &val )
+            {
+                return const_cast<interval_type &>(val.first);
+            }
+
+            static
+            void copy( value_type &to, const value_type &from )
+            {
+                to.second = from.second;
+            }
+
+            static
+            const value_type &val( const_iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            value_type &mutable_val( iterator itr )
+            {
+                return *itr;
+            }
+        };
+    };
+
+}}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // RANKED_MAP_H
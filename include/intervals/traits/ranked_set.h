@@ -0,0 +1,91 @@
+#ifndef ETOOL_INTERVALS_TRAITS_RANKED_SET_H
+#define ETOOL_INTERVALS_TRAITS_RANKED_SET_H
+
+#include "intervals/interval.h"
+#include "intervals/traits/treap.h"
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals { namespace traits {
+
+    /// The set in a treap: the same as 'std_set', and the element
+    /// at a rank is found in O(log n)
+    template <typename KeyT, typename Comparator,
+              typename AllocT = std::allocator<KeyT>,
+              typename LayoutT = typename default_layout<KeyT>::type>
+    struct ranked_set {
+
+        using interval_type     = interval<KeyT, Comparator, LayoutT>;
+        using value_type        = interval_type;
+        using set_cmp           = typename interval_type::cmp_not_overlap;
+        using allocator_type    = AllocT;
+
+        struct key_of {
+
+            using key_type = interval_type;
+
+            static
+            const key_type &get( const value_type &val )
+            {
+                return val;
+            }
+        };
+
+        using container_type    = treap<value_type, key_of, set_cmp,
+                                        no_augment, allocator_type>;
+        using iterator          = typename container_type::iterator;
+        using const_iterator    = typename container_type::const_iterator;
+
+        struct iterator_access {
+
+            static
+            const interval_type &key( const_iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            interval_type &mutable_key( iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            const interval_type &key( const value_type &val )
+            {
+                return val;
+            }
+
+            static
+            interval_type &mutable_key( value_type &val )
+            {
+                return val;
+            }
+
+            static
+            void copy( value_type &, const value_type & )
+            { }
+
+            static
+            const value_type &val( const_iterator itr )
+            {
+                return *itr;
+            }
+
+            static
+            value_type &mutable_val( iterator itr )
+            {
+                return *itr;
+            }
+        };
+    };
+
+}}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // RANKED_SET_H
@@ -11,10 +11,11 @@ namespace INTERVALS_TOP_NANESPACE {
 namespace intervals { namespace traits {
 
     template <typename KeyT, typename ValueT, typename Comparator,
-              typename AllocT>
+              typename AllocT,
+              typename LayoutT = typename default_layout<KeyT>::type>
     struct std_map {
 
-        using interval_type     = interval<KeyT, Comparator>;
+        using interval_type     = interval<KeyT, Comparator, LayoutT>;
         using map_cmp           = typename interval_type::cmp_not_overlap;
 
         using allocator_type    = AllocT;
@@ -11,10 +11,11 @@ namespace INTERVALS_TOP_NANESPACE {
 namespace intervals { namespace traits {
 
     template <typename KeyT, typename Comparator,
-              typename AllocT = std::allocator<KeyT> >
+              typename AllocT = std::allocator<KeyT>,
+              typename LayoutT = typename default_layout<KeyT>::type>
     struct std_set {
 
-        using interval_type     = interval<KeyT, Comparator>;
+        using interval_type     = interval<KeyT, Comparator, LayoutT>;
         using value_type        = interval_type;
         using set_cmp           = typename interval_type::cmp_not_overlap;
         using allocator_type    = AllocT;
@@ -0,0 +1,729 @@
+#ifndef ETOOL_INTERVALS_TRAITS_TREAP_H
+#define ETOOL_INTERVALS_TRAITS_TREAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals { namespace traits {
+
+    /// The policy of the treap without any additional node data
+    struct no_augment {
+
+        struct data_type { };
+
+        template <typename NodeT>
+        static void push( NodeT * )
+        { }
+
+        template <typename NodeT>
+        static void pull( NodeT * )
+        { }
+    };
+
+    /// Randomized balanced tree with the interface of the sorted containers
+    /// that 'tree' uses.
+    /// Every node has 'data' of 'PolicyT::data_type'.
+    ///     'PolicyT::push(node)' moves pending changes of the node
+    ///                           to its children. It's called before
+    ///                           the tree goes down from the node.
+    ///     'PolicyT::pull(node)' recomputes the node's data from
+    ///                           its children after they change.
+    /// A node is seen by the iterators only when all its ancestors
+    /// are pushed, so lazy updates are materialized on the way down.
+    /// The const lookups and iterators push too: with a policy that
+    /// keeps pending changes they write to the nodes, so two const
+    /// readers can't share the treap. After 'flush' nothing is pending
+    /// and the const access only reads until the next change.
+    /// 'touch' marks a node whose value is changed in place;
+    /// 'refresh' pulls the marked nodes and their ancestors.
+    /// Every node also knows the size of its subtree, so 'nth' finds
+    /// the element at a rank in O(log n).
+    template <typename ValueT, typename KeyOfT, typename CompareT,
+              typename PolicyT = no_augment,
+              typename AllocT = std::allocator<ValueT> >
+    class treap {
+
+    public:
+
+        using value_type    = ValueT;
+        using key_type      = typename KeyOfT::key_type;
+        using policy_type   = PolicyT;
+        using data_type     = typename policy_type::data_type;
+
+        struct node {
+
+            node( value_type val, std::uint32_t prio )
+                :value(std::move(val))
+                ,priority(prio)
+            { }
+
+            value_type      value;
+            data_type       data;
+            std::size_t     count = 1;
+            std::uint32_t   priority;
+            node           *left   = nullptr;
+            node           *right  = nullptr;
+            node           *parent = nullptr;
+        };
+
+    private:
+
+        using alloc_traits  = std::allocator_traits<AllocT>;
+        using node_alloc    = typename alloc_traits::template
+                                       rebind_alloc<node>;
+        using node_traits   = std::allocator_traits<node_alloc>;
+
+        template <typename RefT, typename PtrT>
+        class basic_iterator {
+
+        public:
+
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type        = typename treap::value_type;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = PtrT;
+            using reference         = RefT;
+
+            basic_iterator( ) = default;
+
+            /// iterator -> const_iterator
+            template <typename R, typename P>
+            basic_iterator( const basic_iterator<R, P> &other )
+                :node_(other.node_)
+                ,owner_(other.owner_)
+            { }
+
+            reference operator * ( ) const
+            {
+                return node_->value;
+            }
+
+            pointer operator -> ( ) const
+            {
+                return &node_->value;
+            }
+
+            basic_iterator &operator ++ ( )
+            {
+                node_ = treap::next_node( node_ );
+                return *this;
+            }
+
+            basic_iterator operator ++ ( int )
+            {
+                basic_iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            basic_iterator &operator -- ( )
+            {
+                node_ = node_ ? treap::prev_node( node_ )
+                              : treap::rightmost( owner_->root_ );
+                return *this;
+            }
+
+            basic_iterator operator -- ( int )
+            {
+                basic_iterator tmp(*this);
+                --(*this);
+                return tmp;
+            }
+
+            template <typename R, typename P>
+            bool operator == ( const basic_iterator<R, P> &other ) const
+            {
+                return node_ == other.node_;
+            }
+
+            template <typename R, typename P>
+            bool operator != ( const basic_iterator<R, P> &other ) const
+            {
+                return node_ != other.node_;
+            }
+
+            node *get_node( ) const
+            {
+                return node_;
+            }
+
+        private:
+
+            template <typename R, typename P>
+            friend class basic_iterator;
+            friend class treap;
+
+            basic_iterator( node *n, const treap *owner )
+                :node_(n)
+                ,owner_(owner)
+            { }
+
+            node        *node_  = nullptr;
+            const treap *owner_ = nullptr;
+        };
+
+    public:
+
+        using iterator       = basic_iterator<value_type &, value_type *>;
+        using const_iterator = basic_iterator<const value_type &,
+                                              const value_type *>;
+
+        treap( ) = default;
+
+        treap( const treap &other )
+            :alloc_(node_traits::select_on_container_copy_construction(
+                                                            other.alloc_))
+            ,size_(other.size_)
+            ,seed_(other.seed_)
+        {
+            root_ = clone( other.root_, nullptr );
+        }
+
+        treap( treap &&other )
+            :alloc_(std::move(other.alloc_))
+        {
+            swap( other );
+        }
+
+        treap &operator = ( const treap &other )
+        {
+            treap tmp(other);
+            swap( tmp );
+            return *this;
+        }
+
+        treap &operator = ( treap &&other )
+        {
+            treap tmp(std::move(other));
+            swap( tmp );
+            return *this;
+        }
+
+        ~treap( )
+        {
+            destroy( root_ );
+        }
+
+        iterator begin( )
+        {
+            return iterator( leftmost( root_ ), this );
+        }
+
+        const_iterator begin( ) const
+        {
+            return const_iterator( leftmost( root_ ), this );
+        }
+
+        iterator end( )
+        {
+            return iterator( nullptr, this );
+        }
+
+        const_iterator end( ) const
+        {
+            return const_iterator( nullptr, this );
+        }
+
+        std::size_t size( ) const
+        {
+            return size_;
+        }
+
+        bool empty( ) const
+        {
+            return size_ == 0;
+        }
+
+        void swap( treap &other )
+        {
+            std::swap( alloc_, other.alloc_ );
+            std::swap( root_,  other.root_ );
+            std::swap( size_,  other.size_ );
+            std::swap( seed_,  other.seed_ );
+            dirty_.swap( other.dirty_ );
+        }
+
+        void clear( )
+        {
+            destroy( root_ );
+            root_ = nullptr;
+            size_ = 0;
+            dirty_.clear( );
+        }
+
+        iterator lower_bound( const key_type &key )
+        {
+            return iterator( lower_node( root_, key, nullptr ), this );
+        }
+
+        const_iterator lower_bound( const key_type &key ) const
+        {
+            return const_iterator( lower_node( root_, key, nullptr ), this );
+        }
+
+        iterator upper_bound( const key_type &key )
+        {
+            return iterator( upper_node( root_, key, nullptr ), this );
+        }
+
+        const_iterator upper_bound( const key_type &key ) const
+        {
+            return const_iterator( upper_node( root_, key, nullptr ), this );
+        }
+
+        std::pair<iterator, iterator> equal_range( const key_type &key )
+        {
+            auto res = range_nodes( key );
+            return std::make_pair( iterator( res.first,  this ),
+                                   iterator( res.second, this ) );
+        }
+
+        std::pair<const_iterator, const_iterator>
+        equal_range( const key_type &key ) const
+        {
+            auto res = range_nodes( key );
+            return std::make_pair( const_iterator( res.first,  this ),
+                                   const_iterator( res.second, this ) );
+        }
+
+        /// the position is defined by the key; the hint is not used.
+        /// like 'std::set' it doesn't insert an equivalent element
+        iterator emplace_hint( const_iterator, value_type val )
+        {
+            node *same = lower_node( root_, KeyOfT::get( val ), nullptr );
+            if( same && !less( KeyOfT::get( val ), key_of( same ) ) ) {
+                return iterator( same, this );
+            }
+
+            node *n = create( std::move(val) );
+            node *l = nullptr;
+            node *r = nullptr;
+            split_less( root_, key_of( n ), l, r );
+            set_root( merge( merge( l, n ), r ) );
+            ++size_;
+            return iterator( n, this );
+        }
+
+        iterator erase( const_iterator where )
+        {
+            node *n    = where.get_node( );
+            node *next = next_node( n );
+
+            policy_type::push( n );
+            node *sub = merge( n->left, n->right );
+            node *parent = n->parent;
+            if( sub ) {
+                sub->parent = parent;
+            }
+            if( !parent ) {
+                root_ = sub;
+            } else {
+                if( parent->left == n ) {
+                    parent->left = sub;
+                } else {
+                    parent->right = sub;
+                }
+                pull_up( parent );
+            }
+            forget( n );
+            destroy_node( n );
+            --size_;
+            return iterator( next, this );
+        }
+
+        iterator erase( const_iterator from, const_iterator to )
+        {
+            while( from != to ) {
+                from = erase( from );
+            }
+            return iterator( to.get_node( ), this );
+        }
+
+        /// Calls 'call(root)' for the subtree of all the elements
+        /// that overlap 'key'. The subtree is cut out of the tree
+        /// for the call and then put back.
+        template <typename CallT>
+        void update_range( const key_type &key, CallT call )
+        {
+            node *l = nullptr;
+            node *m = nullptr;
+            node *r = nullptr;
+            split_less( root_, key, l, m );
+            split_not_greater( m, key, m, r );
+            if( m ) {
+                m->parent = nullptr;
+                call( m );
+            }
+            set_root( merge( merge( l, m ), r ) );
+        }
+
+        node *root( ) const
+        {
+            return root_;
+        }
+
+        /// the element that has 'rank' elements before it;
+        /// 'end( )' if there are not so many. O(log n)
+        const_iterator nth( std::size_t rank ) const
+        {
+            node *n = root_;
+            while( n ) {
+                policy_type::push( n );
+                const std::size_t left = count_of( n->left );
+                if( rank < left ) {
+                    n = n->left;
+                } else if( rank == left ) {
+                    break;
+                } else {
+                    rank -= left + 1;
+                    n = n->right;
+                }
+            }
+            return const_iterator( n, this );
+        }
+
+        /// the value of the element is going to be changed in place.
+        /// a mutable iterator comes from a mutable treap
+        static
+        void touch( iterator itr )
+        {
+            const_cast<treap *>(itr.owner_)->dirty_.push_back(
+                                                        itr.get_node( ) );
+        }
+
+        void refresh( )
+        {
+            for( auto n: dirty_ ) {
+                pull_up( n );
+            }
+            dirty_.clear( );
+        }
+
+        /// pushes all the pending changes down to the leaves; O(n)
+        void flush( )
+        {
+            push_all( root_ );
+        }
+
+    private:
+
+        static
+        bool less( const key_type &lh, const key_type &rh )
+        {
+            const CompareT cmp;
+            return cmp( lh, rh );
+        }
+
+        static
+        const key_type &key_of( const node *n )
+        {
+            return KeyOfT::get( n->value );
+        }
+
+        static
+        node *leftmost( node *n )
+        {
+            if( n ) {
+                while( n->left ) {
+                    policy_type::push( n );
+                    n = n->left;
+                }
+            }
+            return n;
+        }
+
+        static
+        node *rightmost( node *n )
+        {
+            if( n ) {
+                while( n->right ) {
+                    policy_type::push( n );
+                    n = n->right;
+                }
+            }
+            return n;
+        }
+
+        static
+        node *next_node( node *n )
+        {
+            if( n->right ) {
+                policy_type::push( n );
+                return leftmost( n->right );
+            }
+            node *p = n->parent;
+            while( p && p->right == n ) {
+                n = p;
+                p = p->parent;
+            }
+            return p;
+        }
+
+        static
+        node *prev_node( node *n )
+        {
+            if( n->left ) {
+                policy_type::push( n );
+                return rightmost( n->left );
+            }
+            node *p = n->parent;
+            while( p && p->left == n ) {
+                n = p;
+                p = p->parent;
+            }
+            return p;
+        }
+
+        /// the first node that is not less than 'key'
+        static
+        node *lower_node( node *n, const key_type &key, node *res )
+        {
+            while( n ) {
+                policy_type::push( n );
+                if( less( key_of( n ), key ) ) {
+                    n = n->right;
+                } else {
+                    res = n;
+                    n = n->left;
+                }
+            }
+            return res;
+        }
+
+        /// the first node that is greater than 'key'
+        static
+        node *upper_node( node *n, const key_type &key, node *res )
+        {
+            while( n ) {
+                policy_type::push( n );
+                if( less( key, key_of( n ) ) ) {
+                    res = n;
+                    n = n->left;
+                } else {
+                    n = n->right;
+                }
+            }
+            return res;
+        }
+
+        /// one descent until the first equivalent node; then the bounds
+        /// are searched in its subtrees
+        std::pair<node *, node *> range_nodes( const key_type &key ) const
+        {
+            node *n  = root_;
+            node *hi = nullptr;
+            while( n ) {
+                policy_type::push( n );
+                if( less( key_of( n ), key ) ) {
+                    n = n->right;
+                } else if( less( key, key_of( n ) ) ) {
+                    hi = n;
+                    n  = n->left;
+                } else {
+                    return std::make_pair( lower_node( n->left, key, n ),
+                                           upper_node( n->right, key, hi ) );
+                }
+            }
+            return std::make_pair( hi, hi );
+        }
+
+        /// l: the nodes that are less than 'key'; r: the others
+        static
+        void split_less( node *t, const key_type &key, node *&l, node *&r )
+        {
+            if( !t ) {
+                l = r = nullptr;
+                return;
+            }
+            policy_type::push( t );
+            if( less( key_of( t ), key ) ) {
+                split_less( t->right, key, t->right, r );
+                set_parent( t->right, t );
+                l = t;
+            } else {
+                split_less( t->left, key, l, t->left );
+                set_parent( t->left, t );
+                r = t;
+            }
+            pull( t );
+        }
+
+        /// l: the nodes that are not greater than 'key'; r: the others
+        static
+        void split_not_greater( node *t, const key_type &key,
+                                node *&l, node *&r )
+        {
+            if( !t ) {
+                l = r = nullptr;
+                return;
+            }
+            policy_type::push( t );
+            if( !less( key, key_of( t ) ) ) {
+                split_not_greater( t->right, key, t->right, r );
+                set_parent( t->right, t );
+                l = t;
+            } else {
+                split_not_greater( t->left, key, l, t->left );
+                set_parent( t->left, t );
+                r = t;
+            }
+            pull( t );
+        }
+
+        /// all the nodes of 'l' are less than the nodes of 'r'
+        static
+        node *merge( node *l, node *r )
+        {
+            if( !l ) {
+                return r;
+            }
+            if( !r ) {
+                return l;
+            }
+            if( l->priority > r->priority ) {
+                policy_type::push( l );
+                l->right = merge( l->right, r );
+                set_parent( l->right, l );
+                pull( l );
+                return l;
+            } else {
+                policy_type::push( r );
+                r->left = merge( l, r->left );
+                set_parent( r->left, r );
+                pull( r );
+                return r;
+            }
+        }
+
+        static
+        void set_parent( node *n, node *parent )
+        {
+            if( n ) {
+                n->parent = parent;
+            }
+        }
+
+        static
+        void push_all( node *n )
+        {
+            if( n ) {
+                policy_type::push( n );
+                push_all( n->left );
+                push_all( n->right );
+            }
+        }
+
+        static
+        std::size_t count_of( const node *n )
+        {
+            return n ? n->count : 0;
+        }
+
+        /// the subtree size and then the data of the policy
+        static
+        void pull( node *n )
+        {
+            n->count = 1 + count_of( n->left ) + count_of( n->right );
+            policy_type::pull( n );
+        }
+
+        static
+        void pull_up( node *n )
+        {
+            for( ; n; n = n->parent ) {
+                pull( n );
+            }
+        }
+
+        void forget( node *n )
+        {
+            for( auto itr = dirty_.begin( ); itr != dirty_.end( ); ) {
+                if( *itr == n ) {
+                    itr = dirty_.erase( itr );
+                } else {
+                    ++itr;
+                }
+            }
+        }
+
+        void set_root( node *n )
+        {
+            root_ = n;
+            set_parent( root_, nullptr );
+        }
+
+        std::uint32_t next_priority( )
+        {
+            /// xorshift
+            seed_ ^= seed_ << 13;
+            seed_ ^= seed_ >> 17;
+            seed_ ^= seed_ << 5;
+            return seed_;
+        }
+
+        node *create( value_type val )
+        {
+            node *n = node_traits::allocate( alloc_, 1 );
+            try {
+                node_traits::construct( alloc_, n, std::move(val),
+                                        next_priority( ) );
+            } catch( ... ) {
+                node_traits::deallocate( alloc_, n, 1 );
+                throw;
+            }
+            pull( n );
+            return n;
+        }
+
+        void destroy_node( node *n )
+        {
+            node_traits::destroy( alloc_, n );
+            node_traits::deallocate( alloc_, n, 1 );
+        }
+
+        void destroy( node *n )
+        {
+            if( n ) {
+                destroy( n->left );
+                destroy( n->right );
+                destroy_node( n );
+            }
+        }
+
+        node *clone( const node *n, node *parent )
+        {
+            if( !n ) {
+                return nullptr;
+            }
+            node *res = node_traits::allocate( alloc_, 1 );
+            node_traits::construct( alloc_, res, *n );
+            res->parent = parent;
+            res->left   = nullptr;
+            res->right  = nullptr;
+            res->left   = clone( n->left,  res );
+            res->right  = clone( n->right, res );
+            return res;
+        }
+
+        node_alloc      alloc_;
+        node           *root_ = nullptr;
+        std::size_t     size_ = 0;
+        std::uint32_t   seed_ = 2463534242;
+        std::vector<node *> dirty_;
+    };
+
+}}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // TREAP_H
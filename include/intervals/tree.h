@@ -1,7 +1,13 @@
 #ifndef ETOOL_INTERVALS_TREE_H
 #define ETOOL_INTERVALS_TREE_H
 
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
 #include "intervals/interval.h"
+#include "intervals/search.h"
+#include "intervals/intersection_view.h"
 
 #ifdef INTERVALS_TOP_NANESPACE
 namespace INTERVALS_TOP_NANESPACE {
@@ -9,6 +15,47 @@ namespace INTERVALS_TOP_NANESPACE {
 
 namespace intervals {
 
+    namespace detail {
+
+        /// 'lo' plus 'i' of the 'count' equal steps to 'hi'. The span
+        /// is taken in the unsigned type, so it doesn't overflow
+        /// for the signed domains
+        template <typename T>
+        T span_point( T lo, T hi, std::size_t i, std::size_t count,
+                      std::true_type )
+        {
+            using U = typename std::make_unsigned<T>::type;
+            const std::uintmax_t width = static_cast<U>(
+                                static_cast<U>(hi) - static_cast<U>(lo) );
+            const std::uintmax_t shift = width / count * i;
+            return static_cast<T>( static_cast<U>(
+                                static_cast<U>(lo) + static_cast<U>(shift) ) );
+        }
+
+        /// the floating point domains: 'hi - lo' can be infinite
+        template <typename T>
+        T span_point( T lo, T hi, std::size_t i, std::size_t count,
+                      std::false_type )
+        {
+            const T n = static_cast<T>(count);
+            return lo + ( hi / n - lo / n ) * static_cast<T>(i);
+        }
+
+        /// true_type if the container finds the element at a rank
+        template <typename ContT>
+        struct has_nth {
+
+            template <typename C>
+            static auto check( const C *c ) -> decltype( c->nth( 0 ),
+                                                         std::true_type( ) );
+
+            template <typename C>
+            static std::false_type check( ... );
+
+            using type = decltype( check<ContT>( nullptr ) );
+        };
+    }
+
     template <typename TraitT>
     class tree {
     public:
@@ -58,12 +105,12 @@ namespace intervals {
 
         iterator erase( const_iterator itr )
         {
-            cont_.erase( itr );
+            return cont_.erase( itr );
         }
 
         iterator erase( const_iterator b, const_iterator e )
         {
-            cont_.erase( b, e );
+            return cont_.erase( b, e );
         }
 
         iterator find( const domain_type &key )
@@ -78,41 +125,49 @@ namespace intervals {
 
         iterator find( const key_type &key )
         {
-            using CT  = container_type;
-            using  IA = iterator_access;
-            using cmp = typename key_type::cmp_not_overlap;
-            auto res  = locate<CT, iterator>(cont_, key);
+            using CT = container_type;
+            auto res = overlap_range<CT, iterator>(cont_, key);
+            return select_key(res, cont_.end( ), key);
+        }
 
-            if( res.left.itr != cont_.end( ) ) {
-                if(( res.left.itr == res.right.itr
-                     && res.left.contains
-                     && res.right.contains )
-                  || cmp::equal_empty(IA::key(res.left.itr), key) )
-                {
-                    return res.left.itr;
-                }
-            }
+        const_iterator find( const key_type &key ) const
+        {
+            using CCT = const container_type;
+            auto res  = overlap_range<CCT, const_iterator>(cont_, key);
+            return select_key(res, cont_.end( ), key);
+        }
 
-            return cont_.end( );
+        /// finger search. 'hint' is a position near the expected result;
+        /// for example the result of the previous call
+        iterator find( const_iterator hint, const domain_type &key )
+        {
+            using CT = container_type;
+            auto res = overlap_range<CT, iterator>(cont_, mutable_itr(hint),
+                                                   key);
+            return select_domain(res, cont_.end( ), key);
         }
 
-        const_iterator find( const key_type &key ) const
+        const_iterator find( const_iterator hint,
+                             const domain_type &key ) const
         {
-            using CCT = container_type;
-            using  IA = iterator_access;
-            using cmp = typename key_type::cmp_not_overlap;
-            auto res  = locate<CCT, iterator>(cont_, key);
+            using CCT = const container_type;
+            auto res  = overlap_range<CCT, const_iterator>(cont_, hint, key);
+            return select_domain(res, cont_.end( ), key);
+        }
 
-            if( res.left.itr != cont_.end( ) ) {
-                if(( res.left.itr == res.right.itr
-                     && res.left.contains
-                     && res.right.contains )
-                  || cmp::equal_empty(IA::key(res.left.itr), key) )
-                {
-                    return res.left.itr;
-                }
-            }
-            return cont_.end( );
+        iterator find( const_iterator hint, const key_type &key )
+        {
+            using CT = container_type;
+            auto res = overlap_range<CT, iterator>(cont_, mutable_itr(hint),
+                                                   key);
+            return select_key(res, cont_.end( ), key);
+        }
+
+        const_iterator find( const_iterator hint, const key_type &key ) const
+        {
+            using CCT = const container_type;
+            auto res  = overlap_range<CCT, const_iterator>(cont_, hint, key);
+            return select_key(res, cont_.end( ), key);
         }
 
         bool left_connected( const_iterator itr ) const
@@ -193,7 +248,7 @@ namespace intervals {
         find_intersection( const key_type &key )
         {
             using CT = container_type;
-            auto loc = locate<CT, iterator>(cont_, key);
+            auto loc = overlap_range<CT, iterator>(cont_, key);
             if( loc.right.contains ) {
                 return std::make_pair( loc.left.itr, std::next(loc.right.itr) );
             } else {
@@ -204,8 +259,8 @@ namespace intervals {
         std::pair<const_iterator, const_iterator>
         find_intersection( const key_type &key ) const
         {
-            using CT = container_type;
-            auto loc = locate<CT, const_iterator>(cont_, key);
+            using CCT = const container_type;
+            auto loc  = overlap_range<CCT, const_iterator>(cont_, key);
             if( loc.right.contains ) {
                 return std::make_pair( loc.left.itr, std::next(loc.right.itr) );
             } else {
@@ -213,6 +268,114 @@ namespace intervals {
             }
         }
 
+        /// the elements that intersect 'key' clipped to 'key'.
+        /// the view must not outlive the tree and its modifications
+        intersection_view<trait_type>
+        intersect_view( const key_type &key ) const
+        {
+            auto range = find_intersection( key );
+            return intersection_view<trait_type>( key, range.first,
+                                                  range.second );
+        }
+
+        using range_type = std::pair<const_iterator, const_iterator>;
+
+        /// At most 'count' consecutive non-empty ranges that cover
+        /// the container and have the same number of elements (+/- 1).
+        /// O(count) on the flat backends, O(count * log(n)) on the treap
+        /// backends (ranked and lazy) that know their subtree sizes.
+        /// The std::set and std::map backends don't, so they walk
+        /// the elements: O(n)
+        std::vector<range_type> partition( std::size_t count ) const
+        {
+            using ranked = typename detail::has_nth<container_type>::type;
+
+            std::vector<range_type> res;
+            const std::size_t total = size( );
+            if( count == 0 || total == 0 ) {
+                return res;
+            }
+            count = std::min( count, total );
+            res.reserve( count );
+
+            const_iterator from = begin( );
+            std::size_t pos = 0;
+            for( std::size_t i = 1; i <= count; i++ ) {
+                const std::size_t next = total * i / count;
+                const_iterator to = at_rank( from, next - pos, next,
+                                             ranked( ) );
+                res.emplace_back( from, to );
+                from = to;
+                pos  = next;
+            }
+            return res;
+        }
+
+        /// At most 'count' consecutive non-empty ranges that cover
+        /// the container; the span from the first left end to the last
+        /// right end is cut into equal pieces and every bound starts
+        /// a range at the first element that is not entirely before it.
+        /// Needs arithmetic 'domain_type'.
+        /// O(count * log(n)) on every backend.
+        /// Infinite ends have no span; then it is the same as 'partition',
+        /// which is O(n) on the tree backends
+        std::vector<range_type> partition_span( std::size_t count ) const
+        {
+            using I = iterator_access;
+
+            std::vector<range_type> res;
+            if( count == 0 || empty( ) ) {
+                return res;
+            }
+
+            const key_type &first = I::key(begin( ));
+            const key_type &last  = I::key(std::prev(end( )));
+            auto infinite = [ ]( attributes attr ) {
+                return attr == attributes::MIN_INF
+                    || attr == attributes::MAX_INF;
+            };
+            if( infinite( first.left_attr( ) )
+             || infinite( last.right_attr( ) ) )
+            {
+                return partition( count );
+            }
+
+            using integral = typename std::is_integral<domain_type>::type;
+
+            const_iterator from = begin( );
+            for( std::size_t i = 1; i < count && from != end( ); i++ ) {
+                const domain_type bound = detail::span_point( first.left( ),
+                                                              last.right( ),
+                                                              i, count,
+                                                              integral( ) );
+                const_iterator to = find_intersection( key_type(bound) ).first;
+                if( to != from ) {
+                    res.emplace_back( from, to );
+                    from = to;
+                }
+            }
+            if( from != end( ) ) {
+                res.emplace_back( from, end( ) );
+            }
+            return res;
+        }
+
+    private:
+
+        /// 'from' moved by 'step' to the element at 'rank'
+        const_iterator at_rank( const_iterator from, std::size_t step,
+                                std::size_t, std::false_type ) const
+        {
+            std::advance( from, step );
+            return from;
+        }
+
+        const_iterator at_rank( const_iterator, std::size_t,
+                                std::size_t rank, std::true_type ) const
+        {
+            return cont_.nth( rank );
+        }
+
     protected:
 
         tree( ) = default;
@@ -254,22 +417,293 @@ namespace intervals {
 
         iterator insert_impl( value_type ival )
         {
-#ifdef DEBUG
-            if( I::key(ival).invalid( ) ) {
-                throw std::logic_error( "Insert. Invalid value." );
-                return cont_.end( );
+            using I  = iterator_access;
+            using CT = container_type;
+
+            if( I::key(ival).is_infinite( ) ) {
+                return replace_all( std::move(ival) );
             }
-#endif
+            auto pair = overlap_range<CT, iterator>( cont_, I::key(ival) );
+            return insert_at( pair, std::move(ival) );
+        }
 
-            using I = iterator_access;
+        iterator insert_impl( const_iterator hint, value_type ival )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            if( I::key(ival).is_infinite( ) ) {
+                return replace_all( std::move(ival) );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, mutable_itr(hint),
+                                              I::key(ival) );
+            return insert_at( pair, std::move(ival) );
+        }
+
+        iterator merge_impl( value_type ival )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            if( I::key(ival).is_infinite( ) ) {
+                return replace_all( std::move(ival) );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, I::key(ival) );
+            return merge_at( pair, std::move(ival) );
+        }
+
+        iterator merge_impl( const_iterator hint, value_type ival )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            if( I::key(ival).is_infinite( ) ) {
+                return replace_all( std::move(ival) );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, mutable_itr(hint),
+                                              I::key(ival) );
+            return merge_at( pair, std::move(ival) );
+        }
+
+        iterator absorb_impl( value_type ival )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
 
             if( I::key(ival).is_infinite( ) ) {
+                return replace_all( std::move(ival) );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, I::key(ival) );
+            return absorb_at( pair, std::move(ival) );
+        }
+
+        iterator absorb_impl( const_iterator hint, value_type ival )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            if( I::key(ival).is_infinite( ) ) {
+                return replace_all( std::move(ival) );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, mutable_itr(hint),
+                                              I::key(ival) );
+            return absorb_at( pair, std::move(ival) );
+        }
+
+        iterator cut_impl( const key_type &ival )
+        {
+            using CT = container_type;
+
+            if( ival.is_infinite( ) ) {
                 container_type tmp;
-                tmp.emplace_hint( tmp.begin( ), std::move(ival) );
                 cont_.swap( tmp );
-                return cont_.begin( );
+                return cont_.end( );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, ival );
+            return cut_at( pair, ival );
+        }
+
+        iterator cut_impl( const_iterator hint, const key_type &ival )
+        {
+            using CT = container_type;
+
+            if( ival.is_infinite( ) ) {
+                container_type tmp;
+                cont_.swap( tmp );
+                return cont_.end( );
+            }
+            auto pair = overlap_range<CT, iterator>( cont_, mutable_itr(hint),
+                                                     ival );
+            return cut_at( pair, ival );
+        }
+
+        /// Splits the elements at the endpoints of 'ival'
+        /// and calls 'combine(element, ival)' for every element
+        /// that overlaps 'ival'. The gaps between them are filled
+        /// with 'ival'. Returns the last element of the affected range.
+        template <typename CombineT>
+        iterator aggregate_impl( value_type ival, CombineT combine )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            auto pair = overlap_range<CT, iterator>( cont_, I::key(ival) );
+            return aggregate_at( pair, std::move(ival), combine );
+        }
+
+        template <typename CombineT>
+        iterator aggregate_impl( const_iterator hint, value_type ival,
+                                 CombineT combine )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            auto pair = overlap_range<CT, iterator>( cont_, mutable_itr(hint),
+                                                     I::key(ival) );
+            return aggregate_at( pair, std::move(ival), combine );
+        }
+
+        /// Fuses the connected elements with equal values,
+        /// 'equal(lh, rh)' compares the values.
+        /// All the elements that overlap 'key' are checked, and their
+        /// neighbours as well, so the range touched by a mutation
+        /// is coalesced. Returns the element that covers 'itr' now.
+        template <typename EqualT>
+        iterator coalesce_impl( iterator itr, const key_type &key,
+                                EqualT equal )
+        {
+            using I   = iterator_access;
+            using cmp = typename key_type::cmp_not_overlap;
+
+            if( itr == cont_.end( ) ) {
+                return itr;
             }
-            auto pair = locate<container_type, iterator>( cont_, I::key(ival) );
+
+            const key_type origin = I::key(itr);
+
+            auto cur = itr;
+            while( cur != cont_.begin( )
+               && !cmp::less( I::key(std::prev(cur)), key ) )
+            {
+                --cur;
+            }
+            if( cur != cont_.begin( ) ) {
+                --cur;
+            }
+
+            /// only the elements after 'cur' are erased, so 'cur'
+            /// and 'res' survive on every backend
+            auto res = cont_.end( );
+            while( true ) {
+                auto next = std::next(cur);
+                if( next == cont_.end( ) ) {
+                    break;
+                }
+                if( I::key(next).left_connected( I::key(cur) )
+                 && equal( I::val(cur), I::val(next) ) )
+                {
+                    cur = merge_right( cur );
+                    continue;
+                }
+                if( cmp::less( key, I::key(next) ) ) {
+                    break;
+                }
+                if( res == cont_.end( ) && !cmp::less( I::key(cur), origin ) ) {
+                    res = cur;
+                }
+                cur = next;
+            }
+
+            return ( res == cont_.end( ) ) ? cur : res;
+        }
+
+        /// one linear pass that fuses all the connected elements
+        /// with the same values; the empty elements are dropped
+        template <typename EqualT>
+        void compact_impl( EqualT equal )
+        {
+            using I = iterator_access;
+
+            container_type tmp;
+            auto itr = cont_.begin( );
+            while( itr != cont_.end( ) ) {
+                if( I::key(itr).empty( ) ) {
+                    ++itr;
+                    continue;
+                }
+                value_type cur( std::move(I::mutable_val(itr)) );
+                for( ++itr; itr != cont_.end( ); ++itr ) {
+                    if( I::key(itr).empty( ) ) {
+                        continue;
+                    }
+                    if( I::key(itr).left_connected( I::key(cur) )
+                     && equal( cur, I::val(itr) ) )
+                    {
+                        I::mutable_key(cur).replace_right( I::key(itr) );
+                    } else {
+                        break;
+                    }
+                }
+                tmp.emplace_hint( tmp.end( ), std::move(cur) );
+            }
+            cont_.swap( tmp );
+        }
+
+        /// Splits the elements that stick out of 'key' at its endpoints.
+        /// After that every element that overlaps 'key' lies inside it
+        void split_impl( const key_type &key )
+        {
+            using I  = iterator_access;
+            using CT = container_type;
+
+            if( key.empty( ) ) {
+                return;
+            }
+
+            auto pair = overlap_range<CT, iterator>( cont_, key );
+            if( pair.left.contains ) {
+                auto itr = pair.left.itr;
+                key_type head = I::key(itr).connect_right( key );
+                if( !head.empty( ) ) {
+                    value_type piece;
+                    I::copy(piece, I::val(itr));
+                    I::mutable_key(piece) = std::move(head);
+                    I::mutable_key(itr).replace_left( key );
+                    cont_.emplace_hint( itr, std::move(piece) );
+                    /// the insertion invalidates the array backends
+                    pair = overlap_range<CT, iterator>( cont_, key );
+                }
+            }
+
+            if( pair.right.contains ) {
+                auto itr = pair.right.itr;
+                key_type tail = I::key(itr).connect_left( key );
+                if( !tail.empty( ) ) {
+                    value_type piece;
+                    I::copy(piece, I::val(itr));
+                    I::mutable_key(piece) = std::move(tail);
+                    I::mutable_key(itr).replace_right( key );
+                    cont_.emplace_hint( std::next(itr), std::move(piece) );
+                }
+            }
+        }
+
+        container_type &container( )
+        {
+            return cont_;
+        }
+
+        const container_type &container( ) const
+        {
+            return cont_;
+        }
+
+    private:
+
+        iterator mutable_itr( const_iterator itr )
+        {
+            /// the common way to get 'iterator' from 'const_iterator'
+            return cont_.erase( itr, itr );
+        }
+
+        iterator replace_all( value_type ival )
+        {
+            container_type tmp;
+            tmp.emplace_hint( tmp.begin( ), std::move(ival) );
+            cont_.swap( tmp );
+            return cont_.begin( );
+        }
+
+        iterator insert_at( intersect_pair<iterator> pair, value_type ival )
+        {
+            using I = iterator_access;
+
+#ifdef DEBUG
+            if( I::key(ival).invalid( ) ) {
+                throw std::logic_error( "Insert. Invalid value." );
+                return cont_.end( );
+            }
+#endif
             if( pair.left.itr == cont_.end( ) ) {
                 return cont_.emplace_hint( cont_.end( ), std::move(ival) );
             }
@@ -299,16 +733,17 @@ namespace intervals {
             auto res = cont_.emplace_hint( tmp, std::move(ival) );
 
             if( pair.right.contains && !I::key(last).empty( ) ) {
-                cont_.emplace_hint( res, std::move(last) );
+                /// 'res' is not valid anymore if the backend is an array
+                res = std::prev(cont_.emplace_hint( std::next(res),
+                                                    std::move(last) ));
             }
 
             return res;
         }
 
-        iterator merge_impl( value_type ival )
+        iterator merge_at( intersect_pair<iterator> pair, value_type ival )
         {
-            using I  = iterator_access;
-            using CT = container_type;
+            using I = iterator_access;
 
 #ifdef DEBUG
             if( I::key(ival).invalid( ) ) {
@@ -316,15 +751,6 @@ namespace intervals {
                 return cont_.end( );
             }
 #endif
-
-            if( I::key(ival).is_infinite( ) ) {
-                container_type tmp;
-                tmp.emplace_hint( tmp.begin( ), std::move(ival) );
-                cont_.swap( tmp );
-                return cont_.begin( );
-            }
-
-            auto pair = locate<CT, iterator>( cont_, I::key(ival) );
             if( pair.left.itr == cont_.end( ) && !pair.left.connected ) {
                 return cont_.emplace_hint( cont_.end( ), std::move(ival) );
             }
@@ -345,10 +771,9 @@ namespace intervals {
 
         }
 
-        iterator absorb_impl( value_type ival )
+        iterator absorb_at( intersect_pair<iterator> pair, value_type ival )
         {
-            using I  = iterator_access;
-            using CT = container_type;
+            using I = iterator_access;
 
 #ifdef DEBUG
             if( I::key(ival).invalid( ) ) {
@@ -356,15 +781,6 @@ namespace intervals {
                 return cont_.end( );
             }
 #endif
-
-            if( I::key(ival).is_infinite( ) ) {
-                container_type tmp;
-                tmp.emplace_hint( tmp.begin( ), std::move(ival) );
-                cont_.swap( tmp );
-                return cont_.begin( );
-            }
-
-            auto pair = locate<CT, iterator>( cont_, I::key(ival) );
             if( pair.left.itr == cont_.end( ) && !pair.left.connected ) {
                 return cont_.emplace_hint( cont_.end( ), std::move(ival) );
             }
@@ -400,7 +816,8 @@ namespace intervals {
             if( pair.right.contains ) {
                 I::mutable_key(ival).replace_right(I::key(last_iter));
                 last_iter++;
-                pair.right.connected = I::key(ival)
+                pair.right.connected = ( last_iter != cont_.end( ) )
+                                    && I::key(ival)
                                       .right_connected(I::key(last_iter));
             }
             if( pair.right.connected ) {
@@ -426,24 +843,16 @@ namespace intervals {
 
         }
 
-        iterator cut_impl( const key_type &ival )
+        iterator cut_at( intersect_pair<iterator> pair, const key_type &ival )
         {
-            using I  = iterator_access;
-            using CT = container_type;
+            using I = iterator_access;
+
 #ifdef DEBUG
-            if( I::key(ival).invalid( ) ) {
+            if( ival.invalid( ) ) {
                 throw std::logic_error( "Cut. Invalid value." );
                 return cont_.end( );
             }
 #endif
-
-            if( ival.is_infinite( ) ) {
-                container_type tmp;
-                cont_.swap( tmp );
-                return cont_.end( );
-            }
-
-            auto pair = locate<CT, iterator>( cont_, ival );
             if( pair.left.itr == cont_.end( ) ) {
                 return cont_.end( );
             }
@@ -476,24 +885,190 @@ namespace intervals {
             return tmp;
         }
 
+        template <typename CombineT>
+        iterator aggregate_at( intersect_pair<iterator> pair, value_type ival,
+                               CombineT &combine )
+        {
+            using I   = iterator_access;
+            using EN  = endpoint_name;
+            using cmp = typename key_type::cmp;
+
+#ifdef DEBUG
+            if( I::key(ival).invalid( ) ) {
+                throw std::logic_error( "Aggregate. Invalid value." );
+                return cont_.end( );
+            }
+#endif
+            const key_type &key = I::key(ival);
+
+            if( key.empty( ) ) {
+                return cont_.end( );
+            }
+
+            auto last = pair.right.itr;
+            if( pair.right.contains ) {
+                ++last;
+            }
+
+            /// insertions invalidate the iterators of the array backends
+            /// so the walk keeps only the current one
+            auto count = std::distance( pair.left.itr, last );
+            if( count == 0 ) {
+                return cont_.emplace_hint( last, std::move(ival) );
+            }
+
+            auto itr = pair.left.itr;
+            if( pair.left.contains ) {
+                key_type head = I::key(itr).connect_right( key );
+                if( !head.empty( ) ) {
+                    value_type piece;
+                    I::copy(piece, I::val(itr));
+                    I::mutable_key(piece) = std::move(head);
+                    I::mutable_key(itr).replace_left( key );
+                    itr = cont_.emplace_hint( itr, std::move(piece) );
+                    ++itr;
+                }
+            }
+
+            for( decltype(count) i = 0; i < count; ++i ) {
+
+                key_type gap;
+                bool has_gap = false;
+                if( i == 0 ) {
+                    has_gap = !cmp::template equal_side<EN::LEFT>(
+                                                    key, I::key(itr) );
+                    if( has_gap ) {
+                        gap = key.connect_right( I::key(itr) );
+                    }
+                } else {
+                    auto prev = std::prev(itr);
+                    has_gap = !I::key(itr).left_connected( I::key(prev) );
+                    if( has_gap ) {
+                        gap = key_type::intersection(
+                                    key.connect_left( I::key(prev) ),
+                                    key.connect_right( I::key(itr) ) );
+                    }
+                }
+
+                if( has_gap && !gap.empty( ) ) {
+                    value_type filler;
+                    I::copy(filler, ival);
+                    I::mutable_key(filler) = std::move(gap);
+                    itr = cont_.emplace_hint( itr, std::move(filler) );
+                    ++itr;
+                }
+
+                if( i + 1 == count && pair.right.contains ) {
+                    key_type tail = I::key(itr).connect_left( key );
+                    if( !tail.empty( ) ) {
+                        value_type piece;
+                        I::copy(piece, I::val(itr));
+                        I::mutable_key(piece) = std::move(tail);
+                        I::mutable_key(itr).replace_right( key );
+                        combine( I::mutable_val(itr), ival );
+                        auto next = cont_.emplace_hint( std::next(itr),
+                                                        std::move(piece) );
+                        return std::prev(next);
+                    }
+                }
+
+                combine( I::mutable_val(itr), ival );
+                ++itr;
+            }
+
+            auto prev = std::prev(itr);
+            if( !cmp::template equal_side<EN::RIGHT>( I::key(prev), key ) ) {
+                key_type tail = key.connect_left( I::key(prev) );
+                if( !tail.empty( ) ) {
+                    I::mutable_key(ival) = std::move(tail);
+                    return cont_.emplace_hint( itr, std::move(ival) );
+                }
+            }
+            return prev;
+        }
+
     protected:
 
+        /// The elements that overlap 'ival' form one run under
+        /// 'cmp_not_overlap', so both bounds are found with one
+        /// 'equal_range' call: the descent is shared until it meets the run
+        /// and only then splits. The neighbours of the run give the
+        /// containment and connection flags.
         template <typename Cont, typename ItrT = const_iterator>
         static
-        intersect_pair<ItrT> locate( Cont &cont, const key_type &ival )
+        intersect_pair<ItrT> overlap_range( Cont &cont, const key_type &ival )
         {
 #ifdef DEBUG
             if( !ival.valid( ) ) {
                 throw std::logic_error( "Locate. Invalid value." );
-                return cont_.end( );
             }
 #endif
+            std::pair<ItrT, ItrT> range = cont.equal_range( ival );
+            return make_pair_info<Cont, ItrT>( cont, range.first,
+                                               range.second, ival );
+        }
+
+        /// the same as above but the bounds are searched near the 'hint'.
+        /// random access backends gallop from the hint;
+        /// the others walk a few steps and fall back to 'equal_range'
+        template <typename Cont, typename ItrT = const_iterator>
+        static
+        intersect_pair<ItrT> overlap_range( Cont &cont, ItrT hint,
+                                     const key_type &ival )
+        {
+#ifdef DEBUG
+            if( !ival.valid( ) ) {
+                throw std::logic_error( "Locate. Invalid value." );
+            }
+#endif
+            using I   = iterator_access;
+            using cmp = typename key_type::cmp_not_overlap;
+
+            auto before = [&ival]( ItrT itr ) {
+                return cmp::less( I::key(itr), ival );
+            };
+
+            auto not_after = [&ival]( ItrT itr ) {
+                return !cmp::less( ival, I::key(itr) );
+            };
+
+            ItrT first = cont.begin( );
+            ItrT last  = cont.end( );
+
+            ItrT left = hint;
+            if( !search::partition_point_near( first, hint, last,
+                                               before, left ) )
+            {
+                /// far from the hint: one descent for both bounds
+                return overlap_range<Cont, ItrT>( cont, ival );
+            }
+
+            if( left == last ) {
+                return make_pair_info<Cont, ItrT>( cont, left, left, ival );
+            }
+
+            ItrT right = left;
+            if( !search::partition_point_near( left, left, last,
+                                               not_after, right ) )
+            {
+                std::pair<ItrT, ItrT> range = cont.equal_range( ival );
+                right = range.second;
+            }
+            return make_pair_info<Cont, ItrT>( cont, left, right, ival );
+        }
+
+        /// 'left' and 'right' are the lower and the upper bounds of 'ival'
+        template <typename Cont, typename ItrT>
+        static
+        intersect_pair<ItrT> make_pair_info( Cont &cont,
+                                             ItrT left, ItrT right,
+                                             const key_type &ival )
+        {
             using I = iterator_access;
 
             using res_type  = intersect_pair<ItrT>;
             using info_type = intersect_info<ItrT>;
 
-            ItrT left = cont.lower_bound( ival );
             if( left == cont.end( ) ) {
                 bool border = false;
                 if( left != cont.begin( ) ) {
@@ -517,8 +1092,6 @@ namespace intervals {
             bool right_border  = false;
             bool right_contain = false;
 
-            ItrT right = cont.upper_bound( ival );
-
             if( right != cont.end( ) ) {
                 right_border = ival.right_connected( I::key(right) );
             }
@@ -536,27 +1109,50 @@ namespace intervals {
 
         }
 
-        iterator find_impl( const domain_type &key )
+        template <typename ItrT>
+        static
+        ItrT select_domain( const intersect_pair<ItrT> &res, ItrT end,
+                            const domain_type &key )
         {
-            using I  = iterator_access;
-            using CT = container_type;
+            using I = iterator_access;
+            return ( res.left.itr != end
+                  && I::key(res.left.itr).contains( key ) )
+                 ? res.left.itr
+                 : end;
+        }
 
-            auto res = locate<CT, iterator>( cont_, key );
+        template <typename ItrT>
+        static
+        ItrT select_key( const intersect_pair<ItrT> &res, ItrT end,
+                         const key_type &key )
+        {
+            using  IA = iterator_access;
+            using cmp = typename key_type::cmp_not_overlap;
 
-            return I::key(res.left.itr).contains( key )
-                 ? res.left.itr
-                 : cont_.end( );
+            if( res.left.itr != end ) {
+                if(( res.left.itr == res.right.itr
+                     && res.left.contains
+                     && res.right.contains )
+                  || cmp::equal_empty(IA::key(res.left.itr), key) )
+                {
+                    return res.left.itr;
+                }
+            }
+            return end;
+        }
+
+        iterator find_impl( const domain_type &key )
+        {
+            using CT = container_type;
+            auto res = overlap_range<CT, iterator>( cont_, key );
+            return select_domain( res, cont_.end( ), key );
         }
 
         const_iterator find_const( const domain_type &key ) const
         {
-            using I   = iterator_access;
             using CCT = const container_type;
-            auto res  = locate<CCT, const_iterator>( cont_, key );
-
-            return I::key(res.left.itr).contains(key)
-                 ? res.left.itr
-                 : cont_.end( );
+            auto res  = overlap_range<CCT, const_iterator>( cont_, key );
+            return select_domain( res, cont_.end( ), key );
         }
 
     private:
@@ -0,0 +1,174 @@
+#ifndef ETOOL_INTERVALS_UNION_ITERATOR_H
+#define ETOOL_INTERVALS_UNION_ITERATOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#ifdef INTERVALS_TOP_NANESPACE
+namespace INTERVALS_TOP_NANESPACE {
+#endif
+
+namespace intervals {
+
+    enum class union_rule {
+        MERGE,  /// fuses the overlapped intervals like 'set::merge'
+        ABSORB, /// fuses the connected intervals as well like 'set::absorb'
+    };
+
+    /// Iterates the union of many sets without building it.
+    /// Every set gives its current element to a heap that is ordered
+    /// by the left endpoints; the intervals are fused with 'union_rule'.
+    /// Takes O(k) memory for k sets; 'next' takes O(m log k) where m is
+    /// the number of the fused elements. Any modification of the sets
+    /// invalidates the iterator
+    template <typename SetT>
+    class union_iterator {
+
+    public:
+
+        using set_type          = SetT;
+        using key_type          = typename set_type::key_type;
+        using set_iterator      = typename set_type::const_iterator;
+        using iterator_access   = typename set_type::iterator_access;
+
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = key_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const key_type *;
+        using reference         = const key_type &;
+
+        /// the end
+        union_iterator( ) = default;
+
+        /// 'first' and 'last' give the sets or pointers to them
+        template <typename IterT>
+        union_iterator( IterT first, IterT last,
+                        union_rule rule = union_rule::MERGE )
+            :rule_(rule)
+        {
+            for( ; first != last; ++first ) {
+                const set_type &s = deref( *first );
+                if( s.begin( ) != s.end( ) ) {
+                    heap_.push_back( cursor( s.begin( ), s.end( ) ) );
+                }
+            }
+            std::make_heap( heap_.begin( ), heap_.end( ), later( ) );
+            done_ = !next( cur_ );
+        }
+
+        /// Takes the interval that follows the last taken one;
+        /// '*itr' doesn't change. Returns false when there is nothing left
+        bool next( key_type &res )
+        {
+            using I   = iterator_access;
+            using cmp = typename key_type::cmp_not_overlap;
+
+            if( heap_.empty( ) ) {
+                return false;
+            }
+
+            res = I::key( heap_.front( ).itr );
+            advance( );
+
+            while( !heap_.empty( ) ) {
+                const key_type &top = I::key( heap_.front( ).itr );
+                bool fuse = !cmp::less( res, top )
+                         || ( rule_ == union_rule::ABSORB
+                           && top.left_connected( res ) );
+                if( !fuse ) {
+                    break;
+                }
+                if( key_type::cmp::less_right( res, top ) ) {
+                    res.replace_right( top );
+                }
+                advance( );
+            }
+            return true;
+        }
+
+        reference operator * ( ) const
+        {
+            return cur_;
+        }
+
+        pointer operator -> ( ) const
+        {
+            return &cur_;
+        }
+
+        union_iterator &operator ++ ( )
+        {
+            done_ = !next( cur_ );
+            return *this;
+        }
+
+        /// only the ends are equal
+        bool operator == ( const union_iterator &other ) const
+        {
+            return ( done_ && other.done_ ) || ( this == &other );
+        }
+
+        bool operator != ( const union_iterator &other ) const
+        {
+            return !( *this == other );
+        }
+
+    private:
+
+        struct cursor {
+
+            cursor( set_iterator i, set_iterator e )
+                :itr(i)
+                ,end(e)
+            { }
+
+            set_iterator itr;
+            set_iterator end;
+        };
+
+        /// the heap keeps the leftmost element on the top
+        struct later {
+            bool operator ( )( const cursor &lh, const cursor &rh ) const
+            {
+                using I = iterator_access;
+                return key_type::cmp::less_left( I::key( rh.itr ),
+                                                 I::key( lh.itr ) );
+            }
+        };
+
+        static const set_type &deref( const set_type &s )
+        {
+            return s;
+        }
+
+        static const set_type &deref( const set_type *s )
+        {
+            return *s;
+        }
+
+        /// moves the top set to its next element
+        void advance( )
+        {
+            std::pop_heap( heap_.begin( ), heap_.end( ), later( ) );
+            cursor &last = heap_.back( );
+            if( ++last.itr == last.end ) {
+                heap_.pop_back( );
+            } else {
+                std::push_heap( heap_.begin( ), heap_.end( ), later( ) );
+            }
+        }
+
+        std::vector<cursor> heap_;
+        union_rule          rule_ = union_rule::MERGE;
+        key_type            cur_;
+        bool                done_ = true;
+    };
+
+}
+
+#ifdef INTERVALS_TOP_NANESPACE
+}
+#endif
+
+#endif // UNION_ITERATOR_H
@@ -1,11 +1,35 @@
 #include <cstdint>
+#include <deque>
 #include <random>
+#include <thread>
 
 #include "intervals/set.h"
 #include "intervals/map.h"
+#include "intervals/lookup_cursor.h"
+#include "intervals/interned_map.h"
+#include "intervals/extent_allocator.h"
+#include "intervals/algorithm.h"
+#include "intervals/union_iterator.h"
+#include "intervals/journal.h"
+#include "intervals/sequence_tracker.h"
+#include "intervals/concurrent.h"
+#include "intervals/combining.h"
+#include "intervals/lsm.h"
+#include "intervals/parallel.h"
+#include "intervals/static_map.h"
 
 #include "catch.hpp"
 
+namespace {
+    /// the discrete tests have a comparator of their own
+    struct discrete_less: std::less<std::int32_t> { };
+}
+
+namespace intervals {
+    template <>
+    struct discrete_domain<std::int32_t, discrete_less>: std::true_type { };
+}
+
 namespace {
 
     using u64 = std::uint64_t;
@@ -254,3 +278,2115 @@ SCENARIO( "MAP", "[map]" ) {
     } // GIVEN
 }
 
+
+namespace {
+
+    using ival_flat_set = intervals::flat_set<u64>;
+    using ival_flat_map = intervals::flat_map<u64, std::string>;
+
+    template <typename SetT>
+    std::string to_string( const SetT &s )
+    {
+        std::ostringstream oss;
+        for( auto &v: s ) {
+            oss << v;
+        }
+        return oss.str( );
+    }
+
+    template <typename SetT>
+    void check_hints( )
+    {
+        SetT hinted;
+        SetT plain;
+
+        auto hint = hinted.end( );
+        for( u64 i = 0; i < 100; i++ ) {
+            hint = hinted.insert( hint, ival_type::left_closed( i * 10,
+                                                                i * 10 + 5 ) );
+            plain.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+        REQUIRE( hinted.size( ) == 100 );
+        REQUIRE( to_string( hinted ) == to_string( plain ) );
+
+        for( u64 i = 0; i < 100; i++ ) {
+            auto h = hinted.begin( );
+            std::advance( h, ud( rd ) % hinted.size( ) );
+            auto v = ud( rd ) % 1100;
+            auto k = ival_type::left_closed( v, v + ud( rd ) % 30 );
+            switch( i % 4 ) {
+            case 0:
+                hinted.insert( h, k );
+                plain.insert( k );
+                break;
+            case 1:
+                hinted.merge( h, k );
+                plain.merge( k );
+                break;
+            case 2:
+                hinted.absorb( h, k );
+                plain.absorb( k );
+                break;
+            case 3:
+                hinted.cut( h, k );
+                plain.cut( k );
+                break;
+            }
+            REQUIRE( to_string( hinted ) == to_string( plain ) );
+
+            auto f = ud( rd ) % 1100;
+            auto hf = hinted.find( hinted.begin( ), f );
+            auto pf = plain.find( f );
+            REQUIRE( (hf == hinted.end( )) == (pf == plain.end( )) );
+            if( hf != hinted.end( ) ) {
+                REQUIRE( hf->to_string( ) == pf->to_string( ) );
+            }
+        }
+    }
+}
+
+TEST_CASE( "Hints", "[set][hint]" ) {
+
+    SECTION( "std set backend" ) {
+        check_hints<ival_set>( );
+    }
+
+    SECTION( "array backend" ) {
+        check_hints<ival_flat_set>( );
+    }
+
+    SECTION( "treap backend" ) {
+        check_hints<intervals::ranked_set<u64> >( );
+    }
+
+    SECTION( "map" ) {
+        ival_flat_map im;
+        auto hint = im.end( );
+        for( u64 i = 0; i < 10; i++ ) {
+            hint = im.insert( hint,
+                      std::make_pair( ival_type::left_closed( i, i + 1 ),
+                                      std::to_string( i ) ) );
+        }
+        REQUIRE( im.size( ) == 10 );
+        REQUIRE( im.find( im.end( ), u64(5) )->second == "5" );
+        im.cut( hint, ival_type::closed( 8, 20 ) );
+        REQUIRE( im.size( ) == 8 );
+    }
+}
+
+TEST_CASE( "Overlap range", "[set][find]" ) {
+
+    ival_set      is;
+    ival_flat_set fs;
+    for( u64 i = 0; i < 4; i++ ) {
+        is.insert( ival_type::left_closed( i * 10, i * 10 + 10 ) );
+        fs.insert( ival_type::left_closed( i * 10, i * 10 + 10 ) );
+    }
+
+    const ival_set      &cis = is;
+    const ival_flat_set &cfs = fs;
+
+    auto ir = cis.find_intersection( ival_type::left_closed( 12, 32 ) );
+    auto fr = cfs.find_intersection( ival_type::left_closed( 12, 32 ) );
+
+    REQUIRE( std::distance( ir.first, ir.second ) == 3 );
+    REQUIRE( std::distance( fr.first, fr.second ) == 3 );
+    REQUIRE( ir.first->to_string( ) == "[10, 20)" );
+    REQUIRE( fr.first->to_string( ) == "[10, 20)" );
+
+    REQUIRE( cis.find( ival_type::open( 32, 35 ) )->to_string( ) ==
+             "[30, 40)" );
+    REQUIRE( cfs.find( ival_type::open( 32, 35 ) )->to_string( ) ==
+             "[30, 40)" );
+    REQUIRE( cfs.find( ival_type::open( 10, 35 ) ) == cfs.end( ) );
+    REQUIRE( cfs.find( u64(40) ) == cfs.end( ) );
+}
+
+namespace {
+
+    template <typename SetT>
+    void check_cursor( )
+    {
+        SetT is;
+        for( u64 i = 0; i < 100; i++ ) {
+            is.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+
+        auto cursor = intervals::make_lookup_cursor( is );
+        u64 value = 0;
+        for( u64 i = 0; i < 300; i++ ) {
+            value += ud( rd ) % ( i < 200 ? 7 : 100 );
+            INFO( "seek " << value );
+            REQUIRE( cursor.seek( value ) == is.find( value ) );
+        }
+
+        /// going back is allowed
+        REQUIRE( cursor.seek( 3 ) == is.begin( ) );
+        REQUIRE( cursor.seek( 5 ) == is.end( ) );
+    }
+}
+
+TEST_CASE( "Lookup cursor", "[set][map][cursor]" ) {
+
+    SECTION( "std set backend" ) {
+        check_cursor<ival_set>( );
+    }
+
+    SECTION( "array backend" ) {
+        check_cursor<ival_flat_set>( );
+    }
+
+    SECTION( "map" ) {
+        ival_map im;
+        im[ival_type::left_closed( 0, 10 )]  = "a";
+        im[ival_type::left_closed( 20, 30 )] = "b";
+
+        intervals::lookup_cursor<ival_map> cursor( im );
+        REQUIRE( cursor.seek( 5 )->second == "a" );
+        REQUIRE( cursor.seek( 15 ) == im.end( ) );
+        REQUIRE( cursor.seek( 20 )->second == "b" );
+        REQUIRE( cursor.seek( 30 ) == im.end( ) );
+        REQUIRE( cursor.position( ) == im.end( ) );
+    }
+}
+
+TEST_CASE( "Intersection view", "[set][map][find]" ) {
+
+    SECTION( "set" ) {
+        ival_set is;
+        for( u64 i = 0; i < 4; i++ ) {
+            is.insert( ival_type::left_closed( i * 10, i * 10 + 10 ) );
+        }
+
+        std::ostringstream oss;
+        for( auto v: is.intersect_view( ival_type::open( 12, 32 ) ) ) {
+            oss << v.first;
+        }
+        REQUIRE( oss.str( ) == "(12, 20)[20, 30)[30, 32)" );
+
+        auto in = is.intersect_view( ival_type::closed( 12, 15 ) );
+        REQUIRE( std::distance( in.begin( ), in.end( ) ) == 1 );
+        REQUIRE( (*in.begin( )).first.to_string( ) == "[12, 15]" );
+        REQUIRE( (*in.begin( )).second.to_string( ) == "[10, 20)" );
+
+        REQUIRE( is.intersect_view( ival_type::left_closed( 50 ) ).empty( ) );
+    }
+
+    SECTION( "map" ) {
+        ival_flat_map im;
+        im[ival_type::left_closed( 0, 10 )]  = "a";
+        im[ival_type::left_closed( 20, 30 )] = "b";
+
+        std::ostringstream oss;
+        for( auto v: im.intersect_view( ival_type::infinite( ) ) ) {
+            oss << v.first << v.second;
+        }
+        REQUIRE( oss.str( ) == "[0, 10)a[20, 30)b" );
+
+        oss.str( "" );
+        for( auto v: im.intersect_view( ival_type::left_open( 5, 25 ) ) ) {
+            oss << v.first << v.second;
+        }
+        REQUIRE( oss.str( ) == "(5, 10)a[20, 25]b" );
+    }
+}
+
+namespace {
+
+    ival_type random_interval( u64 range )
+    {
+        u64 a = ud( rd ) % range;
+        u64 b = a + ud( rd ) % 20;
+        switch( ud( rd ) % 4 ) {
+        case 0:  return ival_type::left_closed( a, b );
+        case 1:  return ival_type::closed( a, b );
+        case 2:  return ival_type::open( a, b + 1 );
+        default: return ival_type::left_open( a, b + 1 );
+        }
+    }
+
+    template <typename MapT>
+    void check_aggregate( )
+    {
+        const u64 range = 200;
+
+        MapT im;
+        std::vector<int> values( range + 40, 0 );
+        std::vector<bool> covered( range + 40, false );
+
+        for( int i = 0; i < 200; i++ ) {
+            auto k = random_interval( range );
+            INFO( "aggregate " << k );
+            im.aggregate( std::make_pair( k, 1 ), std::plus<int>( ) );
+            for( u64 p = 0; p < values.size( ); p++ ) {
+                if( k.contains( p ) ) {
+                    values[p] += 1;
+                    covered[p] = true;
+                }
+            }
+
+            for( u64 p = 0; p < values.size( ); p++ ) {
+                INFO( "point " << p );
+                auto f = im.find( p );
+                REQUIRE( (f != im.end( )) == covered[p] );
+                if( covered[p] ) {
+                    REQUIRE( f->second == values[p] );
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE( "Aggregate", "[map][aggregate]" ) {
+
+    SECTION( "std map backend" ) {
+        check_aggregate<intervals::map<u64, int> >( );
+    }
+
+    SECTION( "array backend" ) {
+        check_aggregate<intervals::flat_map<u64, int> >( );
+    }
+
+    SECTION( "aggregating map" ) {
+        intervals::aggregating_map<u64, unsigned> am;
+        am.insert( std::make_pair( ival_type::left_closed( 0, 10 ), 1u ) );
+        am.insert( std::make_pair( ival_type::left_closed( 20, 30 ), 2u ) );
+        am.insert( std::make_pair( ival_type::left_closed( 5, 25 ), 4u ) );
+
+        std::ostringstream oss;
+        for( auto &v: am ) {
+            oss << v.first << v.second;
+        }
+        REQUIRE( oss.str( ) ==
+                 "[0, 5)1[5, 10)5[10, 20)4[20, 25)6[25, 30)2" );
+
+        intervals::aggregating_map<u64, unsigned,
+                                   std::bit_or<unsigned> > flags;
+        flags.insert( std::make_pair( ival_type::left_closed( 0, 10 ), 1u ) );
+        flags.insert( std::make_pair( ival_type::left_closed( 0, 10 ), 2u ) );
+        REQUIRE( flags.size( ) == 1 );
+        REQUIRE( flags.begin( )->second == 3 );
+
+        flags.insert( std::make_pair( ival_type::left_closed( 5, 15 ), 4u ) );
+        oss.str( "" );
+        for( auto &v: flags ) {
+            oss << v.first << v.second;
+        }
+        REQUIRE( oss.str( ) == "[0, 5)3[5, 10)7[10, 15)4" );
+    }
+}
+
+namespace {
+
+    template <typename MapT>
+    std::string map_to_string( const MapT &m )
+    {
+        std::ostringstream oss;
+        for( auto &v: m ) {
+            oss << v.first << "->" << v.second << " ";
+        }
+        return oss.str( );
+    }
+
+    template <typename CoalescingT, typename MapT>
+    void check_coalescing( )
+    {
+        CoalescingT cm;
+        MapT im;
+
+        for( int i = 0; i < 300; i++ ) {
+            auto k = random_interval( 200 );
+            auto v = std::make_pair( k, int(ud( rd ) % 2) );
+            INFO( "step " << i << " " << k << " " << v.second );
+            const MapT prev = im;
+            switch( ud( rd ) % 6 ) {
+            case 0:
+                cm.insert( v );
+                im.insert( v );
+                break;
+            case 1:
+                cm.insert( cm.begin( ), v );
+                im.insert( v );
+                break;
+            case 2:
+                cm.merge( v );
+                im.merge( v );
+                break;
+            case 3:
+                cm.cut( k );
+                im.cut( k );
+                break;
+            case 4:
+                cm.aggregate( v, std::plus<int>( ) );
+                im.aggregate( v, std::plus<int>( ) );
+                break;
+            case 5:
+                cm.absorb( v );
+                im.absorb( v );
+                break;
+            }
+            /// the coalescing map ignores the empty keys,
+            /// the plain one may keep them
+            if( k.empty( ) ) {
+                im = prev;
+            }
+            im.compact( );
+            REQUIRE( map_to_string( cm ) == map_to_string( im ) );
+        }
+    }
+}
+
+TEST_CASE( "Coalescing map", "[map][coalesce]" ) {
+
+    SECTION( "compact" ) {
+        intervals::map<u64, int> im;
+        for( u64 i = 0; i < 30; i += 10 ) {
+            im.insert( std::make_pair( ival_type::left_closed( i, i + 10 ),
+                                       1 ) );
+        }
+        im.insert( std::make_pair( ival_type::left_closed( 40, 50 ), 1 ) );
+        REQUIRE( im.size( ) == 4 );
+        im.compact( );
+        REQUIRE( map_to_string( im ) == "[0, 30)->1 [40, 50)->1 " );
+    }
+
+    SECTION( "std map backend" ) {
+        check_coalescing<intervals::coalescing_map<u64, int>,
+                         intervals::map<u64, int> >( );
+    }
+
+    SECTION( "array backend" ) {
+        using flat_trait = intervals::traits::array_map<u64, int,
+                              std::less<u64>,
+                              std::allocator<std::pair<ival_type, int> > >;
+        using flat_coalescing = intervals::coalescing_map<u64, int,
+                              std::equal_to<int>, std::less<u64>,
+                              std::allocator<std::pair<ival_type, int> >,
+                              flat_trait>;
+        check_coalescing<flat_coalescing, intervals::flat_map<u64, int> >( );
+    }
+}
+
+namespace {
+
+    template <typename OpT>
+    void check_lazy( )
+    {
+        const u64 range = 200;
+
+        intervals::lazy_map<u64, int, OpT> lm;
+        std::vector<int> values( range + 40, 0 );
+        std::vector<bool> covered( range + 40, false );
+
+        for( int i = 0; i < 300; i++ ) {
+            auto k = random_interval( range );
+            int v = int(ud( rd ) % 10);
+            int action = int(ud( rd ) % 4);
+            INFO( "step " << i << " " << action << " " << k << " " << v );
+            if( action == 0 && i % 2 ) {
+                lm.insert( lm.find( k.left( ) ), std::make_pair( k, v ) );
+            } else if( action == 0 ) {
+                lm.insert( std::make_pair( k, v ) );
+            } else if( action == 1 ) {
+                lm.cut( k );
+            } else {
+                lm.range_apply( k, v );
+            }
+            for( u64 p = 0; p < values.size( ); p++ ) {
+                if( !k.contains( p ) ) {
+                    continue;
+                }
+                if( action == 0 ) {
+                    values[p]  = v;
+                    covered[p] = true;
+                } else if( action == 1 ) {
+                    covered[p] = false;
+                } else if( covered[p] ) {
+                    OpT::apply( values[p], v );
+                }
+            }
+
+            auto copy = lm;
+            for( u64 p = 0; p < values.size( ); p++ ) {
+                INFO( "point " << p );
+                auto f = copy.find( p );
+                REQUIRE( (f != copy.end( )) == covered[p] );
+                if( covered[p] ) {
+                    REQUIRE( f->second == values[p] );
+                }
+            }
+
+            std::size_t count = 0;
+            for( auto &e: lm ) {
+                for( u64 p = 0; p < values.size( ); p++ ) {
+                    if( e.first.contains( p ) ) {
+                        REQUIRE( covered[p] );
+                        REQUIRE( e.second == values[p] );
+                    }
+                }
+                ++count;
+            }
+            REQUIRE( count == lm.size( ) );
+        }
+    }
+}
+
+TEST_CASE( "Lazy map", "[map][lazy]" ) {
+
+    SECTION( "add" ) {
+        check_lazy<intervals::lazy::add<int> >( );
+    }
+
+    SECTION( "max" ) {
+        check_lazy<intervals::lazy::max<int> >( );
+    }
+
+    SECTION( "assign" ) {
+        check_lazy<intervals::lazy::assign<int> >( );
+    }
+
+    SECTION( "range add" ) {
+        intervals::lazy_map<u64, int> lm;
+        for( u64 i = 0; i < 50; i += 10 ) {
+            lm.insert( std::make_pair( ival_type::left_closed( i, i + 10 ),
+                                       0 ) );
+        }
+        lm.range_apply( ival_type::left_closed( 5, 25 ), 2 );
+        lm.range_apply( ival_type::left_closed( 20, 40 ), 1 );
+        REQUIRE( map_to_string( lm ) ==
+                 "[0, 5)->0 [5, 10)->2 [10, 20)->2 [20, 25)->3 "
+                 "[25, 30)->1 [30, 40)->1 [40, 50)->0 " );
+
+        REQUIRE( lm.insert( std::make_pair( ival_type::left_closed( 7, 7 ),
+                                            5 ) ) == lm.end( ) );
+        lm.range_apply( ival_type::left_closed( 0, 50 ), 1 );
+        lm.flush( );
+        const auto &clm = lm;
+        REQUIRE( clm.find( 7 )->second  == 3 );
+        REQUIRE( clm.find( 45 )->second == 1 );
+    }
+
+    SECTION( "equivalent hint" ) {
+        using trait = intervals::traits::lazy_map<u64, int,
+                          intervals::lazy::add<int>, std::less<u64>,
+                          std::allocator<std::pair<const ival_type, int> > >;
+        typename trait::container_type cont;
+        cont.emplace_hint( cont.end( ),
+                           std::make_pair( ival_type::left_closed( 0, 10 ),
+                                           1 ) );
+        auto res = cont.emplace_hint( cont.end( ),
+                           std::make_pair( ival_type::left_closed( 5, 15 ),
+                                           2 ) );
+        REQUIRE( cont.size( ) == 1 );
+        REQUIRE( res->second == 1 );
+    }
+}
+
+TEST_CASE( "Interned map", "[map][interned]" ) {
+
+    using interned = intervals::interned_map<u64, std::string>;
+
+    interned im;
+    im.insert( ival_type::left_closed( 0, 100 ), std::string( "public" ) );
+    im.insert( ival_type::left_closed( 20, 30 ), std::string( "private" ) );
+    im.insert( ival_type::left_closed( 50, 60 ), std::string( "private" ) );
+
+    REQUIRE( im.size( ) == 5 );
+    REQUIRE( im.dictionary( ).size( ) == 2 );
+
+    std::ostringstream oss;
+    for( auto itr = im.begin( ); itr != im.end( ); ++itr ) {
+        oss << itr->first << im.value( itr ) << " ";
+    }
+    REQUIRE( oss.str( ) == "[0, 20)public [20, 30)private [30, 50)public "
+                           "[50, 60)private [60, 100)public " );
+
+    im.insert( ival_type::left_closed( 20, 30 ), std::string( "public" ) );
+    im.insert( ival_type::left_closed( 50, 60 ), std::string( "public" ) );
+    im.compact( );
+    REQUIRE( im.size( ) == 1 );
+
+    interned copy = im;
+    im = interned( );
+    REQUIRE( copy.value( copy.begin( ) ) == "public" );
+    REQUIRE( copy.intern( "private" ) == 1 );
+    REQUIRE( copy.dictionary( ).size( ) == 2 );
+}
+
+namespace {
+
+    template <typename MapT>
+    void check_shared_values( )
+    {
+        using acl = std::vector<int>;
+
+        MapT im;
+        im.insert( std::make_pair( ival_type::left_closed( 0, 100 ),
+                                   acl{ 1, 2, 3 } ) );
+        im.insert( std::make_pair( ival_type::left_closed( 20, 30 ),
+                                   acl{ 4 } ) );
+
+        REQUIRE( im.size( ) == 3 );
+        REQUIRE( im.begin( )->second.use_count( ) == 2 );
+
+        auto last = std::prev( im.end( ) );
+        last->second.mutate( ).push_back( 5 );
+        REQUIRE( im.begin( )->second.use_count( ) == 1 );
+        REQUIRE( im.begin( )->second->size( ) == 3 );
+        REQUIRE( last->second->size( ) == 4 );
+
+        im.cut( ival_type::left_closed( 0, 10 ) );
+        REQUIRE( im.begin( )->second.use_count( ) == 1 );
+        std::ostringstream oss;
+        oss << im.begin( )->first;
+        REQUIRE( oss.str( ) == "[10, 20)" );
+    }
+}
+
+TEST_CASE( "Shared values", "[map][shared]" ) {
+
+    SECTION( "std map backend" ) {
+        check_shared_values<intervals::shared_map<u64, std::vector<int> > >( );
+    }
+
+    SECTION( "array backend" ) {
+        check_shared_values<intervals::flat_shared_map<u64,
+                                                       std::vector<int> > >( );
+    }
+}
+
+TEST_CASE( "Extent allocator", "[set][allocator]" ) {
+
+    using allocator = intervals::extent_allocator<u64>;
+
+    SECTION( "policies" ) {
+        allocator ea( ival_type::left_closed( 0, 100 ) );
+        std::ostringstream oss;
+        oss << ea.allocate( 10 ) << ea.allocate( 20 );
+        ea.release( ival_type::left_closed( 0, 10 ) );
+        oss << ea.allocate( 5, 1, intervals::fit::NEXT )
+            << ea.allocate( 5, 1, intervals::fit::FIRST )
+            << ea.allocate( 10, 16 );
+        REQUIRE( oss.str( ) == "[0, 10)[10, 30)[30, 35)[0, 5)[48, 58)" );
+
+        /// free: [5, 10) [35, 48) [58, 100)
+        oss.str( "" );
+        oss << ea.allocate( 12, 1, intervals::fit::BEST )
+            << ea.allocate( 5, 1, intervals::fit::BEST )
+            << ea.allocate( 50 );
+        REQUIRE( oss.str( ) == "[35, 47)[5, 10)[0, 0)" );
+        REQUIRE( ea.largest( ) == 42 );
+
+        ea.release( ival_type::left_closed( 0, 100 ) );
+        REQUIRE( ea.free_extents( ).size( ) == 1 );
+        REQUIRE( ea.largest( ) == 100 );
+    }
+
+    SECTION( "random" ) {
+        const u64 space = 1000;
+        allocator ea( ival_type::left_closed( 0, space ) );
+        std::vector<ival_type> used;
+
+        for( int i = 0; i < 1000; i++ ) {
+            if( used.empty( ) || ud( rd ) % 3 ) {
+                u64 len   = 1 + ud( rd ) % 40;
+                u64 align = u64(1) << ( ud( rd ) % 4 );
+                auto policy = static_cast<intervals::fit>( ud( rd ) % 3 );
+
+                /// the shortest free extent where the aligned run fits
+                u64 best = space + 1;
+                u64 best_len = space + 1;
+                for( auto &f: ea.free_extents( ) ) {
+                    u64 pos = ( f.left( ) + align - 1 ) / align * align;
+                    if( pos + len <= f.right( )
+                     && f.right( ) - f.left( ) < best_len )
+                    {
+                        best = pos;
+                        best_len = f.right( ) - f.left( );
+                    }
+                }
+
+                auto ext = ea.allocate( len, align, policy );
+                REQUIRE( ext.empty( ) == ( best > space ) );
+                if( policy == intervals::fit::BEST && !ext.empty( ) ) {
+                    REQUIRE( ext.left( ) == best );
+                }
+                if( !ext.empty( ) ) {
+                    REQUIRE( ext.left( ) % align == 0 );
+                    REQUIRE( ext.right( ) - ext.left( ) == len );
+                    REQUIRE( ext.right( ) <= space );
+                    used.push_back( ext );
+                }
+            } else {
+                auto pos = ud( rd ) % used.size( );
+                ea.release( used[pos] );
+                used.erase( used.begin( ) + pos );
+            }
+
+            std::vector<int> owners( space, 0 );
+            for( auto &u: used ) {
+                for( u64 p = u.left( ); p < u.right( ); p++ ) {
+                    owners[p]++;
+                }
+            }
+            u64 longest = 0;
+            for( auto &f: ea.free_extents( ) ) {
+                longest = std::max( longest, f.right( ) - f.left( ) );
+                for( u64 p = f.left( ); p < f.right( ); p++ ) {
+                    owners[p]++;
+                }
+            }
+            REQUIRE( std::count( owners.begin( ), owners.end( ), 1 )
+                     == int(space) );
+            REQUIRE( ea.largest( ) == longest );
+        }
+    }
+
+    SECTION( "domain limits" ) {
+        const u64 max = std::numeric_limits<u64>::max( );
+
+        allocator ea( ival_type::left_closed( 0 ) );
+        REQUIRE( ea.largest( ) == max );
+        REQUIRE( ea.allocate( 10 ).to_string( ) == "[0, 10)" );
+        REQUIRE( ea.allocate( 10, 16, intervals::fit::BEST ).to_string( )
+                 == "[16, 26)" );
+        REQUIRE( ea.allocate( max - 26 ).left( ) == 26 );
+        REQUIRE( ea.allocate( 1 ).to_string( ) == "[10, 11)" );
+        REQUIRE( ea.allocate( 8 ).empty( ) );
+
+        allocator top( ival_type::left_closed( max - 5 ) );
+        REQUIRE( top.allocate( 1, 8 ).empty( ) );
+        REQUIRE( top.allocate( 5 ).left( ) == max - 5 );
+        REQUIRE( top.allocate( 1 ).empty( ) );
+
+        allocator closed( ival_type::closed( 10, 19 ) );
+        REQUIRE( closed.largest( ) == 10 );
+        REQUIRE( closed.allocate( 10 ).to_string( ) == "[10, 20)" );
+    }
+}
+
+namespace {
+
+    template <typename MapT>
+    void check_merge_maps( )
+    {
+        const u64 range = 300;
+
+        for( int t = 0; t < 20; t++ ) {
+            MapT a;
+            MapT b;
+            std::vector<int> va( range + 40, -1 );
+            std::vector<int> vb( range + 40, -1 );
+
+            for( int i = 0; i < 40; i++ ) {
+                auto k = random_interval( range );
+                if( k.empty( ) ) {
+                    continue;
+                }
+                int v = int(ud( rd ) % 3);
+                auto &m  = ( i % 2 ) ? a  : b;
+                auto &vv = ( i % 2 ) ? va : vb;
+                m.insert( std::make_pair( k, v ) );
+                for( u64 p = 0; p < vv.size( ); p++ ) {
+                    if( k.contains( p ) ) {
+                        vv[p] = v;
+                    }
+                }
+            }
+
+            auto resolve = []( int x, int y ) { return x * 10 + y; };
+            auto plain = intervals::merge_maps( a, b, resolve );
+            auto fused = intervals::merge_maps( a, b, resolve,
+                                                std::equal_to<int>( ) );
+            INFO( map_to_string( a ) << "| " << map_to_string( b ) );
+
+            for( u64 p = 0; p < va.size( ); p++ ) {
+                INFO( "point " << p );
+                int expected = ( va[p] >= 0 && vb[p] >= 0 )
+                             ? resolve( va[p], vb[p] )
+                             : std::max( va[p], vb[p] );
+                for( auto *m: { &plain, &fused } ) {
+                    auto f = m->find( p );
+                    REQUIRE( (f != m->end( )) == (expected >= 0) );
+                    if( expected >= 0 ) {
+                        REQUIRE( f->second == expected );
+                    }
+                }
+            }
+
+            auto copy = plain;
+            copy.compact( );
+            REQUIRE( map_to_string( copy ) == map_to_string( fused ) );
+        }
+    }
+}
+
+TEST_CASE( "Merge maps", "[map][algorithm]" ) {
+
+    SECTION( "std map backend" ) {
+        check_merge_maps<intervals::map<u64, int> >( );
+    }
+
+    SECTION( "array backend" ) {
+        check_merge_maps<intervals::flat_map<u64, int> >( );
+    }
+
+    SECTION( "resolve" ) {
+        intervals::map<u64, std::string> a;
+        intervals::map<u64, std::string> b;
+        a.insert( std::make_pair( ival_type::left_closed( 0, 10 ), "a" ) );
+        b.insert( std::make_pair( ival_type::left_closed( 5, 15 ), "b" ) );
+        auto res = intervals::merge_maps( a, b,
+                        []( const std::string &x, const std::string &y ) {
+                            return x + y;
+                        } );
+        REQUIRE( map_to_string( res ) ==
+                 "[0, 5)->a [5, 10)->ab [10, 15)->b " );
+    }
+}
+
+namespace {
+
+    template <typename SetT>
+    void check_union( intervals::union_rule rule )
+    {
+        using union_iterator = intervals::union_iterator<SetT>;
+
+        for( int t = 0; t < 20; t++ ) {
+            std::vector<SetT> sets( 1 + ud( rd ) % 10 );
+            SetT expected;
+            for( auto &s: sets ) {
+                for( int i = ud( rd ) % 20; i > 0; i-- ) {
+                    auto k = random_interval( 300 );
+                    if( k.empty( ) ) {
+                        continue;
+                    }
+                    s.merge( k );
+                    if( rule == intervals::union_rule::MERGE ) {
+                        expected.merge( k );
+                    } else {
+                        expected.absorb( k );
+                    }
+                }
+            }
+
+            std::ostringstream oss;
+            for( union_iterator itr( sets.begin( ), sets.end( ), rule );
+                 itr != union_iterator( ); ++itr )
+            {
+                oss << *itr;
+            }
+            REQUIRE( oss.str( ) == to_string( expected ) );
+        }
+    }
+}
+
+TEST_CASE( "Union iterator", "[set][union]" ) {
+
+    SECTION( "merge" ) {
+        check_union<intervals::set<u64> >( intervals::union_rule::MERGE );
+        check_union<ival_flat_set>( intervals::union_rule::MERGE );
+    }
+
+    SECTION( "absorb" ) {
+        check_union<intervals::set<u64> >( intervals::union_rule::ABSORB );
+    }
+
+    SECTION( "pointers and early exit" ) {
+        ival_set a;
+        ival_set b;
+        a.merge( ival_type::left_closed( 0, 10 ) );
+        a.merge( ival_type::left_closed( 30, 40 ) );
+        b.merge( ival_type::left_closed( 5, 20 ) );
+        b.merge( ival_type::left_closed( 20, 25 ) );
+
+        std::vector<const ival_set *> sets{ &a, &b };
+        intervals::union_iterator<ival_set> un( sets.begin( ), sets.end( ) );
+
+        std::ostringstream oss;
+        oss << *un;
+        ival_type next;
+        while( un.next( next ) ) {
+            oss << next;
+        }
+        REQUIRE( oss.str( ) == "[0, 20)[20, 25)[30, 40)" );
+    }
+}
+
+namespace {
+
+    template <typename JournaledT, typename ReplicaT,
+              typename MakeT, typename ShowT>
+    void check_journal( MakeT make, ShowT show )
+    {
+        JournaledT primary;
+        ReplicaT replica;
+
+        for( int i = 0; i < 300; i++ ) {
+            auto k = random_interval( 200 );
+            auto v = make( k );
+            int action = int(ud( rd ) % 6);
+            INFO( "step " << i << " " << action << " " << k );
+            if( k.empty( ) ) {
+                continue;
+            }
+            switch( action ) {
+            case 0:  primary.insert( v );  break;
+            case 1:  primary.merge( v );   break;
+            case 2:  primary.absorb( v );  break;
+            case 3:  primary.cut( k );     break;
+            case 4:
+                if( primary.size( ) ) {
+                    primary.erase( primary.begin( ) );
+                }
+                break;
+            default:
+                primary.insert( primary.begin( ), v );
+                break;
+            }
+            for( auto &change: primary.take_changes( ) ) {
+                intervals::apply_delta( replica, change );
+            }
+            REQUIRE( show( primary ) == show( replica ) );
+        }
+    }
+}
+
+TEST_CASE( "Journal", "[set][map][journal]" ) {
+
+    SECTION( "map" ) {
+        using map_type = intervals::map<u64, int>;
+        check_journal<intervals::journaled<map_type>, map_type>(
+            []( const ival_type &k ) {
+                return std::make_pair( k, int(ud( rd ) % 3) );
+            },
+            map_to_string<map_type> );
+    }
+
+    SECTION( "set" ) {
+        check_journal<intervals::journaled<ival_set>, ival_set>(
+            []( const ival_type &k ) { return k; },
+            to_string<ival_set> );
+    }
+
+    SECTION( "delta" ) {
+        intervals::journaled<intervals::map<u64, int> > primary;
+        for( u64 i = 0; i < 100; i += 10 ) {
+            primary.insert( std::make_pair( ival_type::left_closed( i, i + 5 ),
+                                            1 ) );
+        }
+        primary.take_changes( );
+        primary.insert( std::make_pair( ival_type::left_closed( 51, 52 ), 2 ) );
+        auto changes = primary.take_changes( );
+        REQUIRE( changes.size( ) == 1 );
+        std::ostringstream oss;
+        oss << changes[0].removed << changes[0].inserted.size( );
+        REQUIRE( oss.str( ) == "[50, 55)3" );
+    }
+}
+
+TEST_CASE( "Sequence tracker", "[set][tracker]" ) {
+
+    SECTION( "random order" ) {
+        const u64 total = 500;
+
+        intervals::sequence_tracker<u64> tracker( 0 );
+        std::vector<bool> got( total + 40, false );
+
+        for( int i = 0; i < 400; i++ ) {
+            u64 from = ud( rd ) % total;
+            if( ud( rd ) % 2 ) {
+                from = tracker.watermark( ) + ud( rd ) % 10;
+            }
+            u64 to = from + 1 + ud( rd ) % 8;
+            tracker.receive( from, to );
+            for( u64 p = from; p < to; p++ ) {
+                got[p] = true;
+            }
+
+            u64 mark = 0;
+            while( got[mark] ) {
+                ++mark;
+            }
+            REQUIRE( tracker.watermark( ) == mark );
+
+            ival_set expected;
+            for( u64 p = mark; p < got.size( ); p++ ) {
+                if( got[p] ) {
+                    expected.absorb( ival_type::left_closed( p, p + 1 ) );
+                }
+            }
+            REQUIRE( to_string( tracker.pending( ) ) == to_string( expected ) );
+            REQUIRE( tracker.received( from ) );
+        }
+    }
+
+    SECTION( "advance" ) {
+        intervals::sequence_tracker<u64> tracker( 100 );
+        tracker.receive( 50, 90 );
+        REQUIRE( tracker.watermark( ) == 100 );
+        tracker.receive( 120, 130 );
+        tracker.receive( 140, 150 );
+        tracker.advance( 125 );
+        REQUIRE( tracker.watermark( ) == 130 );
+        REQUIRE( tracker.pending( ).size( ) == 1 );
+        tracker.receive( 130, 140 );
+        REQUIRE( tracker.watermark( ) == 150 );
+        REQUIRE( tracker.pending( ).empty( ) );
+        REQUIRE_FALSE( tracker.received( 150 ) );
+    }
+}
+
+TEST_CASE( "Concurrent", "[set][concurrent]" ) {
+
+    SECTION( "readers" ) {
+        intervals::concurrent<ival_set> cs;
+        const u64 count = 200;
+
+        std::atomic<bool> broken( false );
+        std::vector<std::thread> readers;
+        for( int r = 0; r < 4; r++ ) {
+            readers.emplace_back( [&]( ) {
+                auto reader = cs.attach( );
+                std::size_t last = 0;
+                while( last < count ) {
+                    auto snap = reader.snapshot( );
+                    /// a version is never torn: [0, 1) ... [n - 1, n) * 10
+                    std::size_t size = snap->size( );
+                    u64 expected = 0;
+                    for( auto &v: *snap ) {
+                        if( v.left( ) != expected * 10 ) {
+                            broken = true;
+                        }
+                        ++expected;
+                    }
+                    if( expected != size || size < last ) {
+                        broken = true;
+                    }
+                    last = size;
+                }
+            } );
+        }
+
+        for( u64 i = 0; i < count; i++ ) {
+            cs.update( [i]( ival_set &s ) {
+                s.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+            } );
+        }
+
+        for( auto &r: readers ) {
+            r.join( );
+        }
+
+        REQUIRE_FALSE( broken );
+        REQUIRE( cs.version( ) == count );
+        REQUIRE( cs.attach( ).snapshot( )->size( ) == count );
+    }
+
+    SECTION( "reclamation" ) {
+        intervals::concurrent<ival_set> cs( 2 );
+        auto add = [&cs]( u64 i ) {
+            cs.update( [i]( ival_set &s ) {
+                s.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+            } );
+        };
+
+        auto reader = cs.attach( );
+        add( 0 );
+        REQUIRE( cs.retired_count( ) == 0 );
+        {
+            auto snap = reader.snapshot( );
+            add( 1 );
+            auto inner = reader.snapshot( );
+            add( 2 );
+            add( 3 );
+            REQUIRE( cs.retired_count( ) == 3 );
+            REQUIRE( snap->size( ) == 1 );
+            REQUIRE( inner->size( ) == 2 );
+        }
+        add( 4 );
+        REQUIRE( cs.retired_count( ) == 0 );
+        REQUIRE( reader.snapshot( )->size( ) == 5 );
+
+        auto other = cs.attach( );
+        REQUIRE_THROWS_AS( cs.attach( ), const std::length_error & );
+    }
+}
+
+namespace {
+
+    template <typename MapT>
+    void check_combining_threads( )
+    {
+        intervals::combining<MapT> cm;
+        const u64 threads = 8;
+        const u64 count   = 500;
+
+        std::vector<std::thread> workers;
+        for( u64 t = 0; t < threads; t++ ) {
+            workers.emplace_back( [&cm, t, count]( ) {
+                auto h = cm.attach( );
+                for( u64 i = 0; i < count; i++ ) {
+                    u64 left = ( i * threads + t ) * 2;
+                    h.insert( std::make_pair(
+                            ival_type::left_closed( left, left + 1 ), t ) );
+                }
+            } );
+        }
+        for( auto &w: workers ) {
+            w.join( );
+        }
+
+        cm.visit( [&]( const MapT &m ) {
+            REQUIRE( m.size( ) == threads * count );
+            u64 expected = 0;
+            bool ok = true;
+            for( auto &v: m ) {
+                ok = ok && v.first.left( ) == expected * 2
+                        && v.second == expected % threads;
+                ++expected;
+            }
+            REQUIRE( ok );
+        } );
+    }
+}
+
+TEST_CASE( "Combining", "[set][map][combining]" ) {
+
+    SECTION( "single thread works as the set" ) {
+        intervals::combining<ival_set> cs;
+        auto h = cs.attach( );
+        auto show = [ ]( const ival_type &key ) {
+            std::ostringstream oss;
+            oss << key;
+            return oss.str( );
+        };
+        REQUIRE( show( h.merge( ival_type::left_closed( 0, 10 ) ) )
+                 == "[0, 10)" );
+        REQUIRE( show( h.absorb( ival_type::left_closed( 10, 20 ) ) )
+                 == "[0, 20)" );
+        h.cut( ival_type::closed( 5, 6 ) );
+        cs.visit( [ ]( const ival_set &s ) {
+            REQUIRE( to_string( s ) == "[0, 5)(6, 20)" );
+        } );
+    }
+
+    SECTION( "slots" ) {
+        intervals::combining<ival_set> cs( 1 );
+        auto h = cs.attach( );
+        REQUIRE_THROWS_AS( cs.attach( ), const std::length_error & );
+    }
+
+    SECTION( "array backend works as the map" ) {
+        using map_type = intervals::flat_map<u64, int>;
+        intervals::combining<map_type> cm;
+        map_type single;
+        auto h = cm.attach( );
+
+        for( int i = 0; i < 1000; i++ ) {
+            auto k = random_interval( 200 );
+            auto v = std::make_pair( k, int(ud( rd ) % 10) );
+            int action = int(ud( rd ) % 4);
+            INFO( "step " << i << " " << action << " " << k );
+            if( k.empty( ) ) {
+                continue;
+            }
+            ival_type res;
+            map_type::iterator itr;
+            switch( action ) {
+            case 0:  res = h.insert( v ); itr = single.insert( v ); break;
+            case 1:  res = h.merge( v );  itr = single.merge( v );  break;
+            case 2:  res = h.absorb( v ); itr = single.absorb( v ); break;
+            default:
+                h.cut( k );
+                single.cut( k );
+                itr = single.end( );
+                break;
+            }
+            if( itr != single.end( ) ) {
+                REQUIRE( res.to_string( ) == itr->first.to_string( ) );
+            }
+            cm.visit( [&]( const map_type &m ) {
+                REQUIRE( map_to_string( m ) == map_to_string( single ) );
+            } );
+        }
+    }
+
+    SECTION( "threads" ) {
+        check_combining_threads<intervals::map<u64, u64> >( );
+    }
+
+    SECTION( "threads on the array backend" ) {
+        check_combining_threads<intervals::flat_map<u64, u64> >( );
+    }
+}
+
+namespace {
+
+    template <typename LsmT, typename TreeT, typename MakeT, typename ShowT>
+    void check_lsm( MakeT make, ShowT show )
+    {
+        /// a small memtable, so the compactions run all the time
+        LsmT two_tier( 8 );
+        TreeT single;
+
+        for( int i = 0; i < 1000; i++ ) {
+            auto k = random_interval( 200 );
+            auto v = make( k );
+            int action = int(ud( rd ) % 4);
+            INFO( "step " << i << " " << action << " " << k );
+            if( k.empty( ) ) {
+                continue;
+            }
+            switch( action ) {
+            case 0:  two_tier.insert( v ); single.insert( v ); break;
+            case 1:  two_tier.merge( v );  single.merge( v );  break;
+            case 2:  two_tier.absorb( v ); single.absorb( v ); break;
+            default: two_tier.cut( k );    single.cut( k );    break;
+            }
+
+            u64 point = ud( rd ) % 220;
+            auto found = two_tier.find( point );
+            auto itr = single.find( point );
+            REQUIRE( found.second == ( itr != single.end( ) ) );
+            if( found.second ) {
+                TreeT lh;
+                TreeT rh;
+                lh.insert( found.first );
+                rh.insert( *itr );
+                REQUIRE( show( lh ) == show( rh ) );
+            }
+            if( i % 50 == 0 ) {
+                REQUIRE( show( two_tier.snapshot( ) ) == show( single ) );
+            }
+        }
+        two_tier.flush( );
+        REQUIRE( show( two_tier.snapshot( ) ) == show( single ) );
+    }
+}
+
+TEST_CASE( "LSM", "[set][map][lsm]" ) {
+
+    SECTION( "map" ) {
+        using map_type = intervals::map<u64, int>;
+        check_lsm<intervals::lsm_map<u64, int>, map_type>(
+            []( const ival_type &k ) {
+                return std::make_pair( k, int(ud( rd ) % 3) );
+            },
+            map_to_string<map_type> );
+    }
+
+    SECTION( "set" ) {
+        check_lsm<intervals::lsm_set<u64>, ival_set>(
+            []( const ival_type &k ) { return k; },
+            to_string<ival_set> );
+    }
+
+    SECTION( "tombstones" ) {
+        intervals::lsm_set<u64> two_tier( 1000 );
+        two_tier.insert( ival_type::left_closed( 0, 100 ) );
+        two_tier.flush( );
+        two_tier.cut( ival_type::left_closed( 10, 20 ) );
+        REQUIRE( two_tier.contains( 5 ) );
+        REQUIRE_FALSE( two_tier.contains( 15 ) );
+        two_tier.flush( );
+        REQUIRE_FALSE( two_tier.contains( 15 ) );
+        REQUIRE( to_string( two_tier.snapshot( ) ) == "[0, 10)[20, 100)" );
+    }
+
+    SECTION( "readers" ) {
+        intervals::lsm_set<u64> two_tier( 16 );
+        const u64 count = 300;
+
+        /// the writes go in order, so a point once seen stays
+        std::atomic<bool> broken( false );
+        std::thread reader( [&]( ) {
+            u64 seen = 0;
+            while( seen < count ) {
+                if( two_tier.contains( seen * 10 ) ) {
+                    ++seen;
+                } else if( seen > 0 && !two_tier.contains( 0 ) ) {
+                    broken = true;
+                }
+            }
+        } );
+
+        for( u64 i = 0; i < count; i++ ) {
+            two_tier.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+        reader.join( );
+        REQUIRE_FALSE( broken );
+    }
+}
+
+namespace {
+
+    template <typename SetT>
+    SetT random_runs( std::size_t count, u64 maximum )
+    {
+        SetT res;
+        for( std::size_t i = 0; i < count; i++ ) {
+            auto k = random_interval( maximum );
+            if( !k.empty( ) ) {
+                res.absorb( k );
+            }
+        }
+        return res;
+    }
+
+    template <typename SetT>
+    void check_parallel_algebra( )
+    {
+        for( int i = 0; i < 100; i++ ) {
+            std::size_t threads = 1 + ud( rd ) % 5;
+            auto a = random_runs<SetT>( ud( rd ) % 60, 500 );
+            auto b = random_runs<SetT>( ud( rd ) % 60, 500 );
+            INFO( to_string( a ) << " " << to_string( b ) );
+
+            SetT uni = a;
+            for( auto &k: b ) {
+                uni.absorb( k );
+            }
+
+            SetT diff = a;
+            for( auto &k: b ) {
+                diff.cut( k );
+            }
+
+            SetT rest;
+            rest.insert( ival_type::infinite( ) );
+            for( auto &k: b ) {
+                rest.cut( k );
+            }
+            SetT inter = a;
+            for( auto &k: rest ) {
+                inter.cut( k );
+            }
+
+            REQUIRE( to_string( intervals::parallel_union( a, b, threads ) )
+                     == to_string( uni ) );
+            REQUIRE( to_string( intervals::parallel_difference( a, b,
+                                                                threads ) )
+                     == to_string( diff ) );
+            REQUIRE( to_string( intervals::parallel_intersection( a, b,
+                                                                  threads ) )
+                     == to_string( inter ) );
+        }
+    }
+}
+
+TEST_CASE( "Parallel set algebra", "[set][parallel]" ) {
+
+    SECTION( "set" ) {
+        check_parallel_algebra<ival_set>( );
+    }
+
+    SECTION( "flat set" ) {
+        check_parallel_algebra<ival_flat_set>( );
+    }
+
+    SECTION( "straddling" ) {
+        ival_set a;
+        ival_set b;
+        for( u64 i = 0; i < 100; i++ ) {
+            a.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+        b.insert( ival_type::open( 0, 1000 ) );
+        auto res = intervals::parallel_union( a, b, 4 );
+        REQUIRE( to_string( res ) == "[0, 1000)" );
+        res = intervals::parallel_intersection( a, b, 4 );
+        REQUIRE( res.size( ) == 100 );
+        REQUIRE( res.begin( )->to_string( ) == "(0, 5)" );
+    }
+
+    SECTION( "tree set slices" ) {
+        ival_set a;
+        ival_set b;
+        for( u64 i = 0; i < 100; i++ ) {
+            a.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+            b.insert( ival_type::left_closed( i * 10 + 3, i * 10 + 7 ) );
+        }
+        auto slices = intervals::detail::make_slices( a, b, 4 );
+        REQUIRE( slices.size( ) == 4 );
+        std::ostringstream oss;
+        for( auto &s: slices ) {
+            oss << s;
+        }
+        REQUIRE( oss.str( ) == "(-inf, 250)[250, 500)[500, 750)[750, +inf)" );
+    }
+}
+
+namespace {
+
+    template <typename TreeT, typename RangesT>
+    void check_cover( const TreeT &tree, const RangesT &ranges )
+    {
+        auto from = tree.begin( );
+        for( auto &r: ranges ) {
+            REQUIRE( r.first == from );
+            REQUIRE( r.first != r.second );
+            from = r.second;
+        }
+        REQUIRE( from == tree.end( ) );
+    }
+
+    template <typename SetT>
+    void check_partition( )
+    {
+        SetT empty;
+        REQUIRE( empty.partition( 4 ).empty( ) );
+        REQUIRE( empty.partition_span( 4 ).empty( ) );
+
+        SetT iset;
+        for( u64 i = 0; i < 1000; i++ ) {
+            iset.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+
+        for( std::size_t k: { 1, 3, 7, 64, 1000, 5000 } ) {
+            auto ranges = iset.partition( k );
+            REQUIRE( ranges.size( ) == std::min<std::size_t>( k, 1000 ) );
+            check_cover( iset, ranges );
+            for( auto &r: ranges ) {
+                auto len = std::distance( r.first, r.second );
+                REQUIRE( len >= long(1000 / ranges.size( )) );
+                REQUIRE( len <= long(1000 / ranges.size( ) + 1) );
+            }
+
+            auto spans = iset.partition_span( k );
+            REQUIRE( spans.size( ) <= k );
+            check_cover( iset, spans );
+        }
+
+        /// the span is [0, 10901); its first half has the dense part
+        /// and 45 sparse elements
+        SetT skewed;
+        for( u64 i = 0; i < 100; i++ ) {
+            skewed.insert( ival_type::left_closed( i, i + 1 ) );
+            skewed.insert( ival_type::left_closed( 1000 + i * 100,
+                                                   1000 + i * 100 + 1 ) );
+        }
+        auto spans = skewed.partition_span( 2 );
+        REQUIRE( spans.size( ) == 2 );
+        check_cover( skewed, spans );
+        REQUIRE( std::distance( spans[0].first, spans[0].second ) == 145 );
+
+        SetT inf;
+        inf.insert( ival_type::right_open( 0 ) );
+        inf.insert( ival_type::left_closed( 10, 20 ) );
+        check_cover( inf, inf.partition_span( 2 ) );
+    }
+}
+
+TEST_CASE( "Partition", "[set][map][partition]" ) {
+
+    SECTION( "set" ) {
+        check_partition<ival_set>( );
+    }
+
+    SECTION( "flat set" ) {
+        check_partition<ival_flat_set>( );
+    }
+
+    SECTION( "ranked set" ) {
+        check_partition<intervals::ranked_set<u64> >( );
+
+        intervals::ranked_set<u64> rs;
+        for( u64 i = 0; i < 100; i++ ) {
+            rs.insert( ival_type::left_closed( i * 10, i * 10 + 5 ) );
+        }
+        rs.cut( ival_type::left_closed( 0, 500 ) );
+        auto ranges = rs.partition( 5 );
+        REQUIRE( ranges.size( ) == 5 );
+        check_cover( rs, ranges );
+        REQUIRE( ranges[2].first->to_string( ) == "[700, 705)" );
+    }
+
+    SECTION( "ranked map" ) {
+        intervals::ranked_map<u64, int> im;
+        for( u64 i = 0; i < 10; i++ ) {
+            im.insert( std::make_pair( ival_type::closed( i * 3, i * 3 + 1 ),
+                                       int(i) ) );
+        }
+        auto ranges = im.partition( 3 );
+        REQUIRE( ranges.size( ) == 3 );
+        check_cover( im, ranges );
+        REQUIRE( ranges[1].first->second == 3 );
+    }
+
+    SECTION( "map" ) {
+        intervals::map<u64, int> im;
+        for( u64 i = 0; i < 10; i++ ) {
+            im.insert( std::make_pair( ival_type::closed( i * 3, i * 3 + 1 ),
+                                       int(i) ) );
+        }
+        auto ranges = im.partition( 3 );
+        REQUIRE( ranges.size( ) == 3 );
+        check_cover( im, ranges );
+        REQUIRE( ranges[1].first->second == 3 );
+    }
+
+    SECTION( "domain limits" ) {
+        using i64     = std::int64_t;
+        using limits  = std::numeric_limits<i64>;
+        using ival64  = intervals::interval<i64>;
+        intervals::set<i64> wide;
+        wide.insert( ival64::closed( limits::min( ), limits::min( ) + 1 ) );
+        wide.insert( ival64::closed( -5, 5 ) );
+        wide.insert( ival64::closed( limits::max( ) - 1, limits::max( ) ) );
+        auto spans = wide.partition_span( 4 );
+        REQUIRE( spans.size( ) == 3 );
+        check_cover( wide, spans );
+
+        intervals::set<double> reals;
+        reals.insert( intervals::interval<double>::closed(
+                        -std::numeric_limits<double>::max( ), -1 ) );
+        reals.insert( intervals::interval<double>::closed(
+                        1, std::numeric_limits<double>::max( ) ) );
+        REQUIRE( reals.partition_span( 2 ).size( ) == 2 );
+    }
+}
+
+namespace {
+
+    template <typename WideT, typename PackedT>
+    void check_packed_layout( )
+    {
+        using packed_type = typename PackedT::key_type;
+        using i64 = std::int64_t;
+
+        WideT   wide;
+        PackedT packed;
+
+        for( int i = 0; i < 300; i++ ) {
+            auto k = random_interval( 200 );
+            INFO( "step " << i << " " << k );
+            if( k.empty( ) ) {
+                continue;
+            }
+            packed_type pk( i64(k.left( )), i64(k.right( )),
+                            k.left_attr( ), k.right_attr( ) );
+            switch( ud( rd ) % 4 ) {
+            case 0: wide.insert( k ); packed.insert( pk ); break;
+            case 1: wide.merge( k );  packed.merge( pk );  break;
+            case 2: wide.absorb( k ); packed.absorb( pk ); break;
+            case 3: wide.cut( k );    packed.cut( pk );    break;
+            }
+            REQUIRE( to_string( wide ) == to_string( packed ) );
+
+            u64 point = ud( rd ) % 220;
+            REQUIRE( ( wide.find( point ) == wide.end( ) )
+                  == ( packed.find( i64(point) ) == packed.end( ) ) );
+        }
+    }
+}
+
+TEST_CASE( "Packed layout", "[set][map][layout]" ) {
+
+    using i64         = std::int64_t;
+    using packed      = intervals::layout::packed;
+    using packed_type = intervals::interval<i64, std::less<i64>, packed>;
+    using explicit_type = intervals::interval<u64, std::less<u64>, packed>;
+
+    static_assert( sizeof(packed_type) == 2 * sizeof(i64) + 1,
+                   "no padding" );
+    static_assert( sizeof(explicit_type) < sizeof(ival_type),
+                   "smaller than the default" );
+
+    SECTION( "interval" ) {
+        auto k = packed_type::left_open( -5, 10 );
+        REQUIRE( k.to_string( ) == "(-5, 10]" );
+        REQUIRE( k.left_attr( ) == intervals::attributes::OPEN );
+        REQUIRE( k.right_attr( ) == intervals::attributes::CLOSE );
+        k.replace_left( packed_type::minus_infinite( ) );
+        REQUIRE( k.to_string( ) == "(-inf, 10]" );
+        REQUIRE( k.contains( -100 ) );
+        REQUIRE_FALSE( k.contains( 11 ) );
+
+        std::vector<packed_type> many( 3, k );
+        many.emplace_back( packed_type::closed( 1, 2 ) );
+        REQUIRE( many[3].to_string( ) == "[1, 2]" );
+    }
+
+    SECTION( "set" ) {
+        using alloc = std::allocator<i64>;
+        using trait = intervals::traits::std_set<i64, std::less<i64>,
+                                                 alloc, packed>;
+        check_packed_layout<ival_set,
+                            intervals::set<i64, std::less<i64>,
+                                           alloc, trait> >( );
+    }
+
+    SECTION( "flat set" ) {
+        using alloc = std::allocator<packed_type>;
+        using trait = intervals::traits::array_set<i64, std::less<i64>, alloc,
+                                                   packed>;
+        check_packed_layout<ival_set,
+                            intervals::set<i64, std::less<i64>,
+                                           alloc, trait> >( );
+    }
+
+    SECTION( "map" ) {
+        using alloc = std::allocator<std::pair<const i64, int> >;
+        using trait = intervals::traits::std_map<i64, int, std::less<i64>,
+                                                 alloc, packed>;
+        intervals::map<i64, int, std::less<i64>, alloc, trait> im;
+        im.insert( std::make_pair( packed_type::left_closed( -10, 10 ), 1 ) );
+        im.insert( std::make_pair( packed_type::left_closed( 0, 5 ), 2 ) );
+        REQUIRE( map_to_string( im ) == "[-10, 0)->1 [0, 5)->2 [5, 10)->1 " );
+    }
+
+    SECTION( "flat map over a deque" ) {
+        using elem  = std::pair<packed_type, int>;
+        using alloc = std::allocator<elem>;
+        using trait = intervals::traits::array_map<i64, int, std::less<i64>,
+                                                   alloc, packed,
+                                                   std::deque<elem> >;
+        intervals::map<i64, int, std::less<i64>, alloc, trait> im;
+        im.insert( std::make_pair( packed_type::left_closed( -10, 10 ), 1 ) );
+        im.insert( std::make_pair( packed_type::left_closed( 0, 5 ), 2 ) );
+        REQUIRE( map_to_string( im ) == "[-10, 0)->1 [0, 5)->2 [5, 10)->1 " );
+    }
+}
+
+TEST_CASE( "Encoded comparison", "[interval][encoded]" ) {
+
+    using cmp = ival_type::cmp_not_overlap;
+
+    std::vector<ival_type> keys = {
+        ival_type::infinite( ),
+        ival_type::minus_infinite( ),
+        ival_type::plus_infinite( ),
+        ival_type::left_closed( 5 ),
+        ival_type::left_open( 5 ),
+        ival_type::right_open( 5 ),
+        ival_type::right_closed( 5 ),
+        ival_type::degenerate( 5 ),
+    };
+    for( int i = 0; i < 200; i++ ) {
+        auto k = random_interval( 20 );
+        if( !k.empty( ) ) {
+            keys.push_back( k );
+        }
+    }
+
+    std::size_t mismatches = 0;
+    for( auto &lh: keys ) {
+        for( auto &rh: keys ) {
+            mismatches += ( cmp::less_encoded( lh, rh )
+                         != cmp::less_attrs( lh, rh ) );
+        }
+    }
+    REQUIRE( mismatches == 0 );
+
+    /// the empty intervals keep their rules
+    auto empty = ival_type::left_closed( 5, 5 );
+    REQUIRE_FALSE( cmp::less( empty, empty ) );
+    REQUIRE( cmp::less( empty, ival_type::degenerate( 5 ) ) );
+    REQUIRE( cmp::less( ival_type::closed( 3, 5 ), empty ) );
+}
+
+TEST_CASE( "Discrete domain", "[interval][set][discrete]" ) {
+
+    using i32      = std::int32_t;
+    using ival     = intervals::interval<i32, discrete_less>;
+    using dset     = intervals::set<i32, discrete_less>;
+    using limits   = std::numeric_limits<i32>;
+
+    SECTION( "canonical form" ) {
+        REQUIRE( ival::closed( 1, 2 ).to_string( )      == "[1, 3)" );
+        REQUIRE( ival::open( 0, 5 ).to_string( )        == "[1, 5)" );
+        REQUIRE( ival::left_open( 0, 5 ).to_string( )   == "[1, 6)" );
+        REQUIRE( ival::right_open( 0, 5 ).to_string( )  == "[0, 5)" );
+        REQUIRE( ival::degenerate( 7 ).to_string( )     == "[7, 8)" );
+        REQUIRE( ival::right_closed( 4 ).to_string( )   == "(-inf, 5)" );
+        REQUIRE( ival::left_open( 4 ).to_string( )      == "[5, +inf)" );
+        REQUIRE( ival::open( 4, 5 ).empty( ) );
+        REQUIRE( ival::closed( 0, limits::max( ) ).to_string( )
+                 == "[0, +inf)" );
+
+        REQUIRE( ival::closed( 1, 2 ).right_connected( ival::closed( 3, 4 ) ) );
+        REQUIRE( ival::closed( 3, 4 ).left_connected( ival::closed( 1, 2 ) ) );
+        REQUIRE_FALSE( ival::closed( 1, 2 )
+                      .right_connected( ival::closed( 4, 5 ) ) );
+        REQUIRE( ival::closed( 1, 2 ).contains( 2 ) );
+        REQUIRE_FALSE( ival::closed( 1, 2 ).contains( 3 ) );
+    }
+
+    SECTION( "coalescing" ) {
+        dset s;
+        s.absorb( ival::closed( 1, 2 ) );
+        s.absorb( ival::closed( 3, 4 ) );
+        s.absorb( ival::open( 4, 7 ) );
+        REQUIRE( to_string( s ) == "[1, 7)" );
+        s.absorb( ival::closed( 8, 9 ) );
+        REQUIRE( to_string( s ) == "[1, 7)[8, 10)" );
+        s.absorb( ival::degenerate( 7 ) );
+        REQUIRE( to_string( s ) == "[1, 10)" );
+    }
+
+    SECTION( "meeting open ends" ) {
+        REQUIRE( ival::open( 5, 5 ).to_string( )      == "[6, 6)" );
+        REQUIRE( ival::left_open( 5, 5 ).to_string( ) == "[6, 6)" );
+        REQUIRE( ival::open( 5, 4 ).to_string( )      == "[6, 6)" );
+        REQUIRE( ival::open( 5, 5 ).empty( ) );
+        REQUIRE_FALSE( ival::open( 5, 5 ).invalid( ) );
+
+        /// the same as the empty [a+1, a+1) that a set can keep
+        dset s;
+        dset ref;
+        for( dset *d: { &s, &ref } ) {
+            d->insert( ival::closed( 0, 9 ) );
+            d->insert( ival::closed( 20, 29 ) );
+        }
+        s.cut( ival::open( 4, 4 ) );
+        ref.cut( ival::right_open( 5, 5 ) );
+        s.cut( ival::left_open( 22, 22 ) );
+        ref.cut( ival::right_open( 23, 23 ) );
+        s.insert( ival::open( 25, 25 ) );
+        ref.insert( ival::right_open( 26, 26 ) );
+        s.insert( ival::left_open( 15, 15 ) );
+        ref.insert( ival::right_open( 16, 16 ) );
+        REQUIRE( to_string( s ) == to_string( ref ) );
+
+        for( auto &k: s ) {
+            REQUIRE_FALSE( k.invalid( ) );
+            REQUIRE( k.left( ) <= k.right( ) );
+        }
+        for( i32 v = -1; v < 31; v++ ) {
+            REQUIRE( ( s.find( v ) != s.end( ) )
+                     == ( ( v >= 0 && v < 10 ) || ( v >= 20 && v < 30 ) ) );
+        }
+    }
+
+    SECTION( "random runs" ) {
+        std::mt19937 gen( rd( ) );
+        std::uniform_int_distribution<i32> pos( 0, 200 );
+        std::uniform_int_distribution<i32> len( 0, 5 );
+
+        dset s;
+        std::vector<bool> bits( 220, false );
+        for( int i = 0; i < 100; i++ ) {
+            i32 a = pos( gen );
+            i32 b = a + len( gen );
+            s.absorb( ival::closed( a, b ) );
+            for( i32 v = a; v <= b; v++ ) {
+                bits[v] = true;
+            }
+        }
+
+        /// every element is a maximal run of the set bits
+        for( auto &k: s ) {
+            REQUIRE( bits[k.left( )] );
+            REQUIRE( bits[k.right( ) - 1] );
+            REQUIRE_FALSE( ( k.left( ) > 0 && bits[k.left( ) - 1] ) );
+            REQUIRE_FALSE( bits[k.right( )] );
+        }
+        for( i32 v = 0; v < 220; v++ ) {
+            REQUIRE( ( s.find( v ) != s.end( ) ) == bits[v] );
+        }
+    }
+}
+
+namespace {
+
+    template <typename WideT, typename FixedT>
+    void check_half_open( )
+    {
+        using fixed_type = typename FixedT::key_type;
+        using u32 = std::uint32_t;
+
+        WideT  wide;
+        FixedT fixed;
+
+        for( int i = 0; i < 300; i++ ) {
+            u64 a = 1 + ud( rd ) % 200;
+            u64 b = a + 1 + ud( rd ) % 20;
+            auto k = ival_type::left_closed( a, b );
+            auto fk = fixed_type::left_closed( u32(a), u32(b) );
+            INFO( "step " << i << " " << k );
+            switch( ud( rd ) % 4 ) {
+            case 0: wide.insert( k ); fixed.insert( fk ); break;
+            case 1: wide.merge( k );  fixed.merge( fk );  break;
+            case 2: wide.absorb( k ); fixed.absorb( fk ); break;
+            case 3: wide.cut( k );    fixed.cut( fk );    break;
+            }
+            REQUIRE( to_string( wide ) == to_string( fixed ) );
+
+            u64 point = ud( rd ) % 230;
+            REQUIRE( ( wide.find( point ) == wide.end( ) )
+                  == ( fixed.find( u32(point) ) == fixed.end( ) ) );
+        }
+    }
+}
+
+TEST_CASE( "Half-open layout", "[set][map][layout]" ) {
+
+    using u32   = std::uint32_t;
+    using less  = std::less<u32>;
+    using fixed = intervals::interval<u32, less, intervals::layout::half_open>;
+    using cmp   = fixed::cmp_not_overlap;
+    using alloc = std::allocator<u32>;
+
+    static_assert( sizeof(fixed) == 2 * sizeof(u32), "no attributes" );
+
+    SECTION( "interval" ) {
+        REQUIRE( fixed::left_closed( 1, 5 ).to_string( ) == "[1, 5)" );
+        REQUIRE( fixed::closed( 1, 5 ).to_string( )      == "[1, 6)" );
+        REQUIRE( fixed::open( 1, 5 ).to_string( )        == "[2, 5)" );
+        REQUIRE( fixed::degenerate( 7 ).to_string( )     == "[7, 8)" );
+        REQUIRE( fixed::infinite( ).to_string( )         == "(-inf, +inf)" );
+        REQUIRE( fixed::right_open( 5 ).to_string( )     == "(-inf, 5)" );
+        REQUIRE( fixed::left_closed( 5 ).to_string( )    == "[5, +inf)" );
+
+        auto k = fixed::left_closed( 1, 5 );
+        REQUIRE( k.valid( ) );
+        REQUIRE_FALSE( fixed::left_closed( 5, 1 ).valid( ) );
+        REQUIRE( k.contains( 1 ) );
+        REQUIRE( k.contains( 4 ) );
+        REQUIRE_FALSE( k.contains( 5 ) );
+        REQUIRE( fixed::infinite( ).contains( 100 ) );
+        REQUIRE( k.right_connected( fixed::left_closed( 5, 9 ) ) );
+        REQUIRE_FALSE( k.right_connected( fixed::left_closed( 6, 9 ) ) );
+        REQUIRE_FALSE( fixed::right_open( 5 )
+                      .left_connected( fixed::minus_infinite( ) ) );
+    }
+
+    SECTION( "domain limits" ) {
+        using limits = std::numeric_limits<u32>;
+        const u32 top = limits::max( );
+
+        REQUIRE( fixed::infinite( ).contains( 0 ) );
+        REQUIRE( fixed::infinite( ).contains( top ) );
+        REQUIRE( fixed::left_closed( 7 ).contains( top ) );
+        REQUIRE( fixed::closed( 5, top ).to_string( ) == "[5, +inf)" );
+        REQUIRE( fixed::closed( 5, top ).contains( top ) );
+        REQUIRE( fixed::closed( 5, top - 2 ).to_string( )
+                 == "[5, " + std::to_string( top - 1 ) + ")" );
+        REQUIRE_FALSE( fixed::closed( 5, top - 2 ).contains( top - 1 ) );
+        REQUIRE_FALSE( fixed::right_open( 5 ).contains( top ) );
+        REQUIRE( fixed::closed( 0, 3 ).contains( 0 ) );
+
+        REQUIRE( cmp::less( fixed::closed( 0, 4 ),
+                            fixed::closed( 5, top ) ) );
+        REQUIRE_FALSE( cmp::less( fixed::closed( 5, top ),
+                                  fixed::degenerate( top ) ) );
+        REQUIRE_FALSE( cmp::less( fixed::degenerate( top ),
+                                  fixed::closed( 5, top ) ) );
+
+        using trait = intervals::traits::std_set<u32, less, alloc,
+                                                 intervals::layout::half_open>;
+        intervals::set<u32, less, alloc, trait> s;
+        s.insert( fixed::closed( 5, top ) );
+        REQUIRE( s.find( top ) != s.end( ) );
+        REQUIRE( s.find( u32(5) ) != s.end( ) );
+        REQUIRE( s.find( u32(4) ) == s.end( ) );
+    }
+
+    SECTION( "the same order as the attributes give" ) {
+        std::vector<fixed> keys = {
+            fixed::infinite( ),
+            fixed::minus_infinite( ),
+            fixed::plus_infinite( ),
+            fixed::left_closed( 5 ),
+            fixed::right_open( 5 ),
+            fixed::left_closed( 5, 5 ),
+            fixed::left_closed( 7, 7 ),
+        };
+        for( int i = 0; i < 200; i++ ) {
+            u32 a = 1 + ud( rd ) % 20;
+            keys.push_back( fixed::left_closed( a, a + ud( rd ) % 5 ) );
+        }
+
+        std::size_t mismatches = 0;
+        for( auto &lh: keys ) {
+            for( auto &rh: keys ) {
+                mismatches += ( cmp::less( lh, rh )
+                             != cmp::less_attrs( lh, rh ) );
+            }
+        }
+        REQUIRE( mismatches == 0 );
+    }
+
+    SECTION( "set" ) {
+        using trait = intervals::traits::std_set<u32, less, alloc,
+                                                 intervals::layout::half_open>;
+        check_half_open<ival_set, intervals::set<u32, less, alloc, trait> >( );
+    }
+
+    SECTION( "flat set" ) {
+        using trait = intervals::traits::array_set<u32, less,
+                                                   std::allocator<fixed>,
+                                            intervals::layout::half_open>;
+        check_half_open<ival_set,
+                        intervals::set<u32, less, std::allocator<fixed>,
+                                       trait> >( );
+    }
+
+    SECTION( "map" ) {
+        using map_alloc = std::allocator<std::pair<const u32, int> >;
+        using trait = intervals::traits::std_map<u32, int, less, map_alloc,
+                                                 intervals::layout::half_open>;
+        intervals::map<u32, int, less, map_alloc, trait> im;
+        im.insert( std::make_pair( fixed::left_closed( 10, 30 ), 1 ) );
+        im.insert( std::make_pair( fixed::closed( 15, 19 ), 2 ) );
+        REQUIRE( map_to_string( im )
+                 == "[10, 15)->1 [15, 20)->2 [20, 30)->1 " );
+    }
+}
+
+namespace {
+
+    using char_class = std::pair<ival_type, char>;
+
+    constexpr char_class char_classes[ ] = {
+        { ival_type::closed( '0', '9' ),        'd' },
+        { ival_type::closed( 'A', 'Z' ),        'u' },
+        { ival_type::right_open( 'a', 'z' ),    'l' },
+        { ival_type::degenerate( 'z' ),         'z' },
+        { ival_type::left_open( 127 ),          'x' },
+    };
+
+    constexpr auto char_map = intervals::make_static_interval_map(
+                                                            char_classes );
+
+    static_assert( char_map.size( ) == 5, "five classes" );
+    static_assert( char_map.contains( '5' ), "a digit" );
+    static_assert( !char_map.contains( ' ' ), "not a class" );
+    static_assert( char_map.lookup( 'q' )->second == 'l', "lower" );
+    static_assert( char_map.lookup( 'z' )->second == 'z', "the last one" );
+    static_assert( char_map.lookup( 200 )->second == 'x', "to +inf" );
+    static_assert( ival_type::closed( 1, 5 ).contains( 5 ), "constexpr" );
+    static_assert( !ival_type::open( 1, 5 ).contains( 5 ), "constexpr" );
+    static_assert( ival_type::cmp_not_overlap::less(
+                        ival_type::right_open( 1, 5 ),
+                        ival_type::closed( 5, 6 ) ), "constexpr" );
+
+    /// the canonical forms are made in the constant expressions too
+    static_assert( intervals::interval<std::int32_t, discrete_less>
+                             ::closed( 1, 5 ).right( ) == 6, "[1, 6)" );
+    static_assert( intervals::interval<std::uint32_t,
+                                       std::less<std::uint32_t>,
+                                       intervals::layout::half_open>
+                             ::open( 1, 5 ).left( ) == 2, "[2, 5)" );
+}
+
+TEST_CASE( "Static interval map", "[map][static]" ) {
+
+    SECTION( "lookup" ) {
+        for( u64 c = 0; c < 300; c++ ) {
+            INFO( "value " << c );
+            auto itr = char_map.find( c );
+            REQUIRE( itr == char_map.lookup( c ) );
+            char expected = ( c >= '0' && c <= '9' ) ? 'd'
+                          : ( c >= 'A' && c <= 'Z' ) ? 'u'
+                          : ( c >= 'a' && c <  'z' ) ? 'l'
+                          : ( c == 'z' )             ? 'z'
+                          : ( c > 127 )              ? 'x'
+                          :                            0;
+            if( expected ) {
+                REQUIRE( itr != char_map.end( ) );
+                REQUIRE( itr->second == expected );
+            } else {
+                REQUIRE( itr == char_map.end( ) );
+            }
+        }
+    }
+
+    SECTION( "the same as a map" ) {
+        std::vector<std::pair<ival_type, int> > src;
+        for( u64 i = 0; i < 33; i++ ) {
+            src.emplace_back( ival_type::left_closed( i * 10, i * 10 + 7 ),
+                              int(i) );
+        }
+        std::pair<ival_type, int> arr[33] = { };
+        std::copy( src.begin( ), src.end( ), arr );
+        auto sm = intervals::make_static_interval_map( arr );
+
+        intervals::map<u64, int> im;
+        for( auto &e: src ) {
+            im.insert( e );
+        }
+        for( u64 v = 0; v < 340; v++ ) {
+            auto itr = im.find( v );
+            auto sitr = sm.find( v );
+            REQUIRE( ( itr == im.end( ) ) == ( sitr == sm.end( ) ) );
+            if( sitr != sm.end( ) ) {
+                REQUIRE( sitr->second == itr->second );
+            }
+        }
+    }
+
+    SECTION( "bad arrays" ) {
+        using pair_type = std::pair<ival_type, int>;
+        pair_type unsorted[ ] = {
+            { ival_type::closed( 5, 6 ), 1 },
+            { ival_type::closed( 1, 2 ), 2 },
+        };
+        pair_type overlapped[ ] = {
+            { ival_type::closed( 1, 5 ), 1 },
+            { ival_type::closed( 5, 6 ), 2 },
+        };
+        pair_type empty[ ] = {
+            { ival_type::left_closed( 1, 1 ), 1 },
+        };
+        REQUIRE_THROWS_AS( intervals::make_static_interval_map( unsorted ),
+                           const std::logic_error & );
+        REQUIRE_THROWS_AS( intervals::make_static_interval_map( overlapped ),
+                           const std::logic_error & );
+        REQUIRE_THROWS_AS( intervals::make_static_interval_map( empty ),
+                           const std::logic_error & );
+    }
+}
+
+namespace {
+
+    static_assert( std::is_trivially_copyable<ival_type>::value,
+                   "trivially copyable" );
+    static_assert( std::is_nothrow_move_constructible<ival_type>::value
+                && std::is_nothrow_move_assignable<ival_type>::value,
+                   "noexcept moves" );
+    static_assert( std::is_nothrow_move_constructible<
+                        intervals::interval<std::string> >::value,
+                   "noexcept moves of the strings" );
+    static_assert( intervals::is_trivially_relocatable<
+                        std::pair<ival_type, int> >::value,
+                   "map values are relocatable" );
+    static_assert( !intervals::is_trivially_relocatable<
+                        std::pair<ival_type, std::string> >::value,
+                   "but not with strings" );
+
+    /// owns a pointer: relocatable, but the destructor isn't trivial
+    struct owner {
+
+        owner( ) = default;
+
+        explicit owner( int val )
+            :ptr(new int(val))
+        {
+            ++alive;
+        }
+
+        owner( owner &&other ) noexcept
+            :ptr(std::move(other.ptr))
+        { }
+
+        owner( const owner &other )
+            :ptr(other.ptr ? new int(*other.ptr) : nullptr)
+        {
+            alive += ( ptr != nullptr );
+        }
+
+        /// the old pointer goes away with 'other'
+        owner &operator = ( owner other )
+        {
+            std::swap( ptr, other.ptr );
+            return *this;
+        }
+
+        ~owner( )
+        {
+            alive -= ( ptr != nullptr );
+        }
+
+        std::unique_ptr<int> ptr;
+        static int alive;
+    };
+
+    int owner::alive = 0;
+
+    std::ostream &operator << ( std::ostream &os, const owner &val )
+    {
+        return os << ( val.ptr ? *val.ptr : -1 );
+    }
+}
+
+namespace intervals {
+    template <>
+    struct is_trivially_relocatable<owner>: std::true_type { };
+}
+
+TEST_CASE( "Relocatable values", "[set][map][relocate]" ) {
+
+    SECTION( "memmove and element by element" ) {
+        intervals::map<u64, int>              im;
+        intervals::flat_map<u64, int>         fm;
+        intervals::flat_map<u64, std::string> sm;
+        for( int i = 0; i < 300; i++ ) {
+            auto k = random_interval( 200 );
+            INFO( "step " << i << " " << k );
+            if( k.empty( ) ) {
+                continue;
+            }
+            if( ud( rd ) % 4 == 0 ) {
+                im.cut( k );
+                fm.cut( k );
+                sm.cut( k );
+            } else {
+                im.insert( std::make_pair( k, i ) );
+                fm.insert( std::make_pair( k, i ) );
+                sm.insert( std::make_pair( k, std::to_string( i ) ) );
+            }
+            REQUIRE( map_to_string( im ) == map_to_string( fm ) );
+            REQUIRE( map_to_string( im ) == map_to_string( sm ) );
+        }
+    }
+
+    SECTION( "a destructor that isn't trivial" ) {
+        using owner_map = intervals::flat_map<u64, owner>;
+        static_assert( owner_map::container_type::relocatable::value,
+                       "shifted by memmove" );
+        {
+            intervals::map<u64, int> im;
+            owner_map om;
+            for( int i = 0; i < 300; i++ ) {
+                auto k = random_interval( 200 );
+                INFO( "step " << i << " " << k );
+                if( k.empty( ) ) {
+                    continue;
+                }
+                if( ud( rd ) % 4 == 0 ) {
+                    im.cut( k );
+                    om.cut( k );
+                } else {
+                    im.insert( std::make_pair( k, i ) );
+                    om.insert( std::make_pair( k, owner( i ) ) );
+                }
+                REQUIRE( map_to_string( im ) == map_to_string( om ) );
+                REQUIRE( owner::alive == int(om.size( )) );
+            }
+        }
+        REQUIRE( owner::alive == 0 );
+    }
+
+    SECTION( "erase of many" ) {
+        using owner_map = intervals::flat_map<u64, owner>;
+        {
+            owner_map om;
+            for( int i = 0; i < 100; i++ ) {
+                om.insert( std::make_pair( ival_type::left_closed( i, i + 1 ),
+                                           owner( i ) ) );
+            }
+            /// 3 values are put aside on the stack, 50 are rotated
+            om.cut( ival_type::left_closed( 10, 13 ) );
+            om.cut( ival_type::left_closed( 20, 70 ) );
+            REQUIRE( om.size( ) == 47 );
+            REQUIRE( owner::alive == 47 );
+            REQUIRE( *om.find( u64(9) )->second.ptr == 9 );
+            REQUIRE( *om.find( u64(13) )->second.ptr == 13 );
+            REQUIRE( *om.find( u64(70) )->second.ptr == 70 );
+            REQUIRE( om.find( u64(11) ) == om.end( ) );
+            REQUIRE( om.find( u64(50) ) == om.end( ) );
+        }
+        REQUIRE( owner::alive == 0 );
+
+        intervals::flat_map<u64, int> fm;
+        for( int i = 0; i < 100; i++ ) {
+            fm.insert( std::make_pair( ival_type::left_closed( i, i + 1 ),
+                                       i ) );
+        }
+        fm.cut( ival_type::left_closed( 20, 70 ) );
+        REQUIRE( fm.size( ) == 50 );
+        REQUIRE( fm.find( u64(70) )->second == 70 );
+        REQUIRE( std::prev( fm.find( u64(70) ) )->second == 19 );
+    }
+}